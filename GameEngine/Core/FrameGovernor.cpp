@@ -0,0 +1,113 @@
+#include "../Core/FrameGovernor.h"
+
+// Cheapest losses first; the last levels draw the whole frame at lower resolution.
+// Off-screen animation goes before parallax: it is the larger saving with many
+// entities and is not seen: a clip catches up by the time it missed once it is back.
+static const QualitySettings QUALITY_LEVELS[] =
+{
+	{ true,  true,  true,  1.0f },
+	{ false, true,  true,  1.0f },
+	{ false, true,  false, 1.0f },
+	{ false, false, false, 1.0f },
+	{ false, false, false, 0.75f },
+	{ false, false, false, 0.5f },
+};
+
+constexpr int FrameGovernor::SHED_FRAMES;
+constexpr int FrameGovernor::RESTORE_FRAMES;
+constexpr int FrameGovernor::MAX_RESTORE_FRAMES;
+constexpr float FrameGovernor::RESTORE_HEADROOM;
+constexpr float FrameGovernor::SMOOTHING;
+
+FrameGovernor::FrameGovernor()
+{
+	m_budget = 1.0f / 60.0f;
+	m_busyTime = 0;
+	for (int i = 0; i < (int)FrameStage::Count; ++i)
+	{
+		m_stageTimes[i] = 0;
+		m_frameStageTimes[i] = 0;
+		m_stageStart[i] = 0;
+	}
+	m_frameStart = 0;
+	m_level = 0;
+	m_overFrames = 0;
+	m_underFrames = 0;
+	m_restoreFrames = RESTORE_FRAMES;
+	m_sinceRestore = MAX_RESTORE_FRAMES;
+}
+
+int FrameGovernor::GetMaxQualityLevel()
+{
+	return (int)(sizeof(QUALITY_LEVELS) / sizeof(QUALITY_LEVELS[0])) - 1;
+}
+
+const QualitySettings& FrameGovernor::GetSettings()
+{
+	return QUALITY_LEVELS[m_level];
+}
+
+float FrameGovernor::Seconds(Uint64 _from, Uint64 _to)
+{
+	return (float)(_to - _from) / (float)SDL_GetPerformanceFrequency();
+}
+
+void FrameGovernor::BeginFrame()
+{
+	m_frameStart = SDL_GetPerformanceCounter();
+	for (int i = 0; i < (int)FrameStage::Count; ++i)
+		m_frameStageTimes[i] = 0;
+}
+
+void FrameGovernor::BeginStage(FrameStage _stage)
+{
+	m_stageStart[(int)_stage] = SDL_GetPerformanceCounter();
+}
+
+void FrameGovernor::EndStage(FrameStage _stage)
+{
+	m_frameStageTimes[(int)_stage] += Seconds(m_stageStart[(int)_stage], SDL_GetPerformanceCounter());
+}
+
+void FrameGovernor::EndFrame()
+{
+	float frameTime = Seconds(m_frameStart, SDL_GetPerformanceCounter());
+	float busy = frameTime - m_frameStageTimes[(int)FrameStage::Idle];
+	m_busyTime += (busy - m_busyTime) * SMOOTHING;
+	for (int i = 0; i < (int)FrameStage::Count; ++i)
+		m_stageTimes[i] += (m_frameStageTimes[i] - m_stageTimes[i]) * SMOOTHING;
+
+	if (m_sinceRestore < MAX_RESTORE_FRAMES) m_sinceRestore++;
+
+	if (m_busyTime > m_budget)
+	{
+		m_underFrames = 0;
+		if (++m_overFrames >= SHED_FRAMES && m_level < GetMaxQualityLevel())
+		{
+			// Restored too early: wait longer before trying this level again
+			if (m_sinceRestore < m_restoreFrames)
+				m_restoreFrames = std::min(m_restoreFrames * 2, MAX_RESTORE_FRAMES);
+			m_level++;
+			m_overFrames = 0;
+		}
+	}
+	else if (m_busyTime < m_budget * RESTORE_HEADROOM)
+	{
+		m_overFrames = 0;
+		if (++m_underFrames >= m_restoreFrames && m_level > 0)
+		{
+			m_level--;
+			m_underFrames = 0;
+			m_sinceRestore = 0;
+		}
+	}
+	else
+	{
+		m_overFrames = 0;
+		m_underFrames = 0;
+	}
+
+	// Long enough since the last restore: forget the backoff from failed ones
+	if (m_sinceRestore >= MAX_RESTORE_FRAMES && m_overFrames == 0)
+		m_restoreFrames = RESTORE_FRAMES;
+}
@@ -0,0 +1,73 @@
+#ifndef FRAME_GOVERNOR_H
+#define FRAME_GOVERNOR_H
+
+#include "../Core/StandardIncludes.h"
+
+// Parts of a frame timed separately; Idle is CapFPS's sleep
+enum class FrameStage { Simulate, Draw, Idle, Present, Count };
+
+// What one quality level keeps, from level 0 (everything) down
+struct QualitySettings
+{
+	bool debugOverlays;         // F1/F2 overlays, when toggled on
+	bool parallaxLayers;        // Off: only the farthest background layer
+	bool offscreenAnimation;    // Off: AnimationSystem stops advancing clips outside the view
+	float resolutionScale;      // Fraction of the window's resolution drawn
+};
+
+/**
+ * Sheds optional work while frames run over budget and restores it when they don't.
+ *
+ * A frame's busy time is its length minus the Idle stage. Once the smoothed
+ * busy time has been over budget for SHED_FRAMES frames the quality level goes
+ * up a step; once it has been under RESTORE_HEADROOM of the budget for the
+ * restore delay it comes back down. A level that has to be shed again soon
+ * after being restored doubles the delay before it is tried next, so the
+ * level does not flap around the budget.
+ */
+class FrameGovernor : public Singleton<FrameGovernor>
+{
+public:
+	//Constructors/ Destructors
+	FrameGovernor();
+	virtual ~FrameGovernor() { }
+
+	//Accessors
+	int GetQualityLevel() { return m_level; }	// 0 = full quality
+	int GetMaxQualityLevel();
+	const QualitySettings& GetSettings();
+	float GetBudget() { return m_budget; }
+	void SetBudget(float _seconds) { m_budget = _seconds; }
+	float GetBusyTime() { return m_busyTime; }	// Smoothed, in seconds
+	float GetStageTime(FrameStage _stage) { return m_stageTimes[(int)_stage]; }
+
+	//Methods
+	void BeginFrame();
+	void BeginStage(FrameStage _stage);
+	void EndStage(FrameStage _stage);
+	// Call at the end of a frame that should count towards the budget
+	void EndFrame();
+
+private:
+	float Seconds(Uint64 _from, Uint64 _to);
+
+	static constexpr int SHED_FRAMES = 15;
+	static constexpr int RESTORE_FRAMES = 120;
+	static constexpr int MAX_RESTORE_FRAMES = 1920;
+	static constexpr float RESTORE_HEADROOM = 0.7f;
+	static constexpr float SMOOTHING = 0.1f;
+
+	float m_budget;
+	float m_busyTime;
+	float m_stageTimes[(int)FrameStage::Count];
+	float m_frameStageTimes[(int)FrameStage::Count];
+	Uint64 m_stageStart[(int)FrameStage::Count];
+	Uint64 m_frameStart;
+	int m_level;
+	int m_overFrames;
+	int m_underFrames;
+	int m_restoreFrames;		// Current restore delay
+	int m_sinceRestore;			// Frames since the level last came down
+};
+
+#endif // FRAME_GOVERNOR_H
@@ -8,6 +8,8 @@
 #include "../Audio/GameAudioManager.h"
 #include "../Resources/AssetController.h"
 #include "../Core/Timing.h"
+#include "../Core/JobSystem.h"
+#include "../Core/FrameGovernor.h"
 #include "../Game/ChunkMap.h"
 #include "../Game/GameUI.h"
 
@@ -28,16 +30,24 @@ void GameController::Initialize()
 
     GameAudioManager::Instance().Initialize();
 
+    // Leave one core for the main thread, which also helps run jobs while it waits
+    unsigned int cores = std::thread::hardware_concurrency();
+    JobSystem::Instance().Initialize(cores > 1 ? cores - 1 : 0);
+
+    // Shared animation sets, loaded once for every entity that uses them
+    AnimationLibrary::Instance().Load();
+
     m_chunkMap = new ChunkMap();
     m_chunkMap->SetEntityManager(&m_entityManager);
+    m_chunkMap->SetTaskQueue(&m_tasks);
     m_chunkMap->LoadDefaultChunks();
     m_renderer->SetLogicalSizeFromMapHeight(m_chunkMap->GetMapPixelHeight());
 
     float sx, sy;
     m_chunkMap->GetPlayerSpawnPoint(sx, sy);
-    m_player = EntityFactory::CreatePlayer(sx, sy);
-    m_entityManager.GetAllEntities().push_back(m_player);
+    m_player = EntityFactory::CreatePlayer(m_entityManager, sx, sy);
     m_entityManager.SetChunkMap(m_chunkMap);
+    SubscribeAudio();
 
     m_gameUI = new GameUI();
     m_gameUI->Initialize();
@@ -49,6 +59,8 @@ void GameController::ShutDown()
 {
     m_entityManager.Clear();
     m_player = nullptr;
+    AnimationLibrary::Instance().Unload();
+    JobSystem::Instance().Shutdown();
     delete m_gameUI; m_gameUI = nullptr;
     delete m_camera; m_camera = nullptr;
     delete m_chunkMap; m_chunkMap = nullptr;
@@ -57,6 +69,37 @@ void GameController::ShutDown()
     delete Texture::Pool; Texture::Pool = nullptr;
 }
 
+void GameController::SubscribeAudio()
+{
+    // Dispatch runs inside SimulateFrame, which may be on a worker, so the
+    // handlers only note the type; PlayQueuedSounds plays them on this thread
+    EventBus& events = m_entityManager.GetEvents();
+    for (int type = 0; type < (int)GameEventType::Count; ++type)
+        events.Subscribe((GameEventType)type, [this, type](const GameEventBatch&) { m_queuedSounds |= 1u << type; });
+}
+
+void GameController::PlayQueuedSounds()
+{
+    // One sound per event type per frame, however many events were raised
+    GameAudioManager& audio = GameAudioManager::Instance();
+    for (int type = 0; type < (int)GameEventType::Count; ++type)
+    {
+        if (!(m_queuedSounds & (1u << type))) continue;
+        switch ((GameEventType)type)
+        {
+        case GameEventType::PlayerJumped: audio.PlayPlayerJumpSound(); break;
+        case GameEventType::PlayerDashed: audio.PlayDashSound(); break;
+        case GameEventType::PlayerPunched: audio.PlayPunchSound(); break;
+        case GameEventType::CoinCollected: audio.PlayClickSound(); break;
+        case GameEventType::EnemyStomped: audio.PlayEnemyStompSound(); break;
+        case GameEventType::PlayerHurt: audio.PlayHurtSound(); break;
+        case GameEventType::PlayerDied: audio.PlayDieSound(); break;
+        default: break;
+        }
+    }
+    m_queuedSounds = 0;
+}
+
 void GameController::HandleInput(SDL_Event& e)
 {
     if (e.type == SDL_QUIT) m_quit = true;
@@ -74,6 +117,28 @@ void GameController::HandleInput(SDL_Event& e)
         m_entityManager.ToggleCollisionBoxDebug();
     }
 
+    // F3 toggles single-threaded jobs, every frame then runs in a fixed order
+    if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F3)
+    {
+        JobSystem& jobs = JobSystem::Instance();
+        jobs.SetSingleThreaded(!jobs.IsSingleThreaded());
+    }
+
+    // F4 switches the collision grid between the hashed and flat backends
+    if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F4)
+    {
+        bool flat = m_entityManager.GetGridBackend() == GridBackend::Flat;
+        m_entityManager.SetGridBackend(flat ? GridBackend::Hashed : GridBackend::Flat);
+    }
+
+    // F5 steps the collider overlap kernel through scalar, SSE and AVX, as far as the CPU allows
+    if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F5)
+    {
+        OverlapKernel kernel = ColliderBoxes::GetKernel();
+        bool widest = kernel == ColliderBoxes::DetectKernel();
+        ColliderBoxes::SetKernel(widest ? OverlapKernel::Scalar : static_cast<OverlapKernel>(static_cast<int>(kernel) + 1));
+    }
+
     m_gameUI->HandleInput(e, m_renderer);
 
     if (m_gameUI->IsStartRequested()) 
@@ -110,22 +175,31 @@ void GameController::RunGame()
     t.SetFPS(60);
     Initialize();
 
+    FrameGovernor& governor = FrameGovernor::Instance();
+    governor.SetBudget(1.0f / t.GetTargetFPS());
+
     while (!m_quit)
     {
         t.Tick();
-        m_renderer->SetDrawColor(Color(255, 255, 255, 255));
-        m_renderer->ClearScreen();
+        governor.BeginFrame();
 
         while (SDL_PollEvent(&m_event)) HandleInput(m_event);
 
+        const QualitySettings& quality = governor.GetSettings();
+        m_renderer->SetResolutionScale(quality.resolutionScale);
+        m_entityManager.SetOffscreenAnimation(quality.offscreenAnimation);
+
+        m_renderer->BeginFrame();
+        m_renderer->SetDrawColor(Color(255, 255, 255, 255));
+        m_renderer->ClearScreen();
+
         m_gameUI->Update(t.GetDeltaTime());
 
-        int hp = 0, maxHp = 3;
         bool dead = false, fullyDead = false;
         if (m_player)
         {
             auto* h = m_player->GetComponent<HealthComponent>();
-            if (h) { hp = h->health; maxHp = h->maxHealth; dead = h->isDead; fullyDead = h->isFullyDead; }
+            if (h) { dead = h->isDead; fullyDead = h->isFullyDead; }
         }
 
         UIState state = m_gameUI->GetState();
@@ -162,69 +236,179 @@ void GameController::RunGame()
         {
             m_gameUI->Render(m_renderer, m_score, 0, 3);
             t.CapFPS();
-            SDL_RenderPresent(m_renderer->GetRenderer());
+            m_renderer->Present();
             continue;
         }
 
         if (state == UIState::Paused)
         {
-            m_chunkMap->RenderBackgrounds(m_renderer, m_camera);
-            m_chunkMap->Render(m_renderer, m_camera);
-            m_entityManager.Render(m_renderer, m_camera);
-            m_gameUI->Render(m_renderer, m_score, hp, maxHp);
+            const RenderSnapshot& snapshot = m_snapshots[m_front];
+            DrawSnapshot(snapshot);
+            m_gameUI->Render(m_renderer, snapshot.score, snapshot.health, snapshot.maxHealth);
             t.CapFPS();
-            SDL_RenderPresent(m_renderer->GetRenderer());
+            m_renderer->Present();
             continue;
         }
 
         if (fullyDead && state == UIState::Playing)
             m_gameUI->SetState(UIState::GameOver);
 
-        if (!dead)
+        m_viewSize = m_renderer->GetLogicalSize();
+        m_windowSize = m_renderer->GetWindowSize();
+
+        // Pipelined: simulate the next frame on a worker while this one is drawn
+        // from the snapshot the previous frame left behind
+        bool pipelined = CanPipeline();
+        float deltaTime = t.GetDeltaTime();
+        if (pipelined)
+        {
+            JobSystem::Instance().Submit([this, deltaTime, dead, fullyDead]()
+            {
+                SimulateFrame(deltaTime, dead, fullyDead);
+            }, &m_frameCounter);
+        }
+        else
         {
-            Point sz = m_renderer->GetLogicalSize();
-            m_entityManager.SetScrollParams(m_camera->GetX(), sz.X, m_chunkMap->GetChunkPixelWidth());
-            m_entityManager.Update(t.GetDeltaTime());
-            m_score += m_entityManager.GetScore();
-            m_entityManager.ResetScore();
+            SimulateFrame(deltaTime, dead, fullyDead);
+            SwapSnapshots();
+            PlayQueuedSounds();
+        }
+
+        governor.BeginStage(FrameStage::Draw);
+        const RenderSnapshot& snapshot = m_snapshots[m_front];
+        DrawSnapshot(snapshot);
 
-            if (m_player) m_camera->FollowEntity(m_player, m_renderer);
-            m_chunkMap->Update(m_camera->GetX(), (float)sz.X);
+        // Debug overlays read live simulation state, so they only draw in-order frames
+        if (DebugOverlaysVisible())
+        {
+            // Render spatial grid debug overlay (F1)
+            m_entityManager.RenderSpatialGridDebug(m_renderer, m_camera, (float)m_viewSize.X, (float)m_viewSize.Y);
 
-            if (m_player)
+            // Render collision box debug overlay (F2)
+            if (m_collisionBoxDebug)
             {
-                auto* tr = m_player->GetComponent<TransformComponent>();
-                if (tr && tr->worldX < m_camera->GetMaxX()) tr->worldX = m_camera->GetMaxX();
+                m_chunkMap->RenderCollisionDebug(m_renderer, m_camera);
+                m_entityManager.RenderCollisionBoxDebug(m_renderer, m_camera);
             }
         }
-        else if (!fullyDead)
+
+        m_gameUI->Render(m_renderer, snapshot.score, snapshot.health, snapshot.maxHealth);
+        governor.EndStage(FrameStage::Draw);
+
+        governor.BeginStage(FrameStage::Idle);
+        t.CapFPS();
+        governor.EndStage(FrameStage::Idle);
+
+        governor.BeginStage(FrameStage::Present);
+        m_renderer->Present();
+        governor.EndStage(FrameStage::Present);
+
+        if (pipelined)
         {
-            auto* h = m_player->GetComponent<HealthComponent>();
-            auto* s = m_player->GetComponent<SpriteComponent>();
-            if (h) { h->deathTimer += t.GetDeltaTime(); if (h->deathTimer >= h->deathDuration) h->isFullyDead = true; }
-            if (s) s->currentAnimation = "hurt";
+            JobSystem::Instance().Wait(&m_frameCounter);
+            SwapSnapshots();
+            PlayQueuedSounds();
         }
 
-        m_chunkMap->RenderBackgrounds(m_renderer, m_camera);
-        m_chunkMap->Render(m_renderer, m_camera);
-        if (!fullyDead) m_entityManager.Render(m_renderer, m_camera);
-        
-        // Render spatial grid debug overlay (F1)
-        Point logicalSize = m_renderer->GetLogicalSize();
-        m_entityManager.RenderSpatialGridDebug(m_renderer, m_camera, (float)logicalSize.X, (float)logicalSize.Y);
-        
-        // Render collision box debug overlay (F2)
-        if (m_collisionBoxDebug)
+        governor.EndFrame();
+    }
+}
+
+bool GameController::DebugOverlaysVisible()
+{
+    if (!FrameGovernor::Instance().GetSettings().debugOverlays) return false;
+    return m_collisionBoxDebug || m_entityManager.IsSpatialGridDebugEnabled();
+}
+
+bool GameController::CanPipeline()
+{
+    // Needs a worker to overlap with, and a finished frame to draw meanwhile
+    if (JobSystem::Instance().IsSingleThreaded()) return false;
+    if (DebugOverlaysVisible()) return false;
+    return m_snapshots[m_front].valid;
+}
+
+void GameController::SimulateFrame(float _frameTime, bool _dead, bool _fullyDead)
+{
+    FrameGovernor& governor = FrameGovernor::Instance();
+    governor.BeginStage(FrameStage::Simulate);
+
+    if (!_dead)
+    {
+        Simulate(_frameTime);
+        if (m_player) m_camera->FollowEntity(m_player, m_viewSize.X, m_interpolation);
+    }
+    else if (!_fullyDead)
+    {
+        // The simulation has stopped; animations and the death timer (which sets isFullyDead) still run
+        m_entityManager.AdvanceTimers(_frameTime);
+        m_entityManager.AdvanceAnimation(_frameTime);
+        auto* s = m_player->GetComponent<SpriteComponent>();
+        if (s) s->clip = AnimClip::Hurt;
+    }
+
+    m_tasks.Run(TASK_BUDGET_MS);
+
+    RenderSnapshot& snapshot = m_snapshots[1 - m_front];
+    snapshot.Clear();
+    snapshot.cameraX = m_camera->GetX();
+    m_chunkMap->ExtractVisibleChunks(snapshot.cameraX, (float)m_viewSize.X, snapshot.chunks);
+
+    snapshot.drawEntities = !_fullyDead;
+    if (snapshot.drawEntities)
+        m_entityManager.ExtractSprites(snapshot.cameraX, (float)m_windowSize.X, m_interpolation, snapshot.sprites);
+
+    snapshot.score = m_score;
+    snapshot.health = 0;
+    snapshot.maxHealth = 3;
+    auto* h = m_player ? m_player->GetComponent<HealthComponent>() : nullptr;
+    if (h) { snapshot.health = h->health; snapshot.maxHealth = h->maxHealth; }
+    snapshot.valid = true;
+
+    governor.EndStage(FrameStage::Simulate);
+}
+
+void GameController::DrawSnapshot(const RenderSnapshot& _snapshot)
+{
+    m_chunkMap->RenderBackgrounds(m_renderer, _snapshot.cameraX, !FrameGovernor::Instance().GetSettings().parallaxLayers);
+    m_chunkMap->Render(m_renderer, _snapshot.cameraX, _snapshot.chunks);
+    if (_snapshot.drawEntities) RenderSystem::Draw(m_renderer, _snapshot.sprites);
+}
+
+void GameController::Simulate(float _frameTime)
+{
+    m_accumulator += _frameTime;
+
+    int ticks = 0;
+    while (m_accumulator >= m_fixedStep && ticks < MAX_TICKS_PER_FRAME)
+    {
+        const Point& sz = m_viewSize;
+        m_entityManager.SetScrollParams(m_camera->GetX(), sz.X, m_chunkMap->GetChunkPixelWidth());
+
+        float activeLeft, activeRight;
+        m_chunkMap->GetActivityRegion(m_camera->GetX(), (float)sz.X, activeLeft, activeRight);
+        m_entityManager.SetActivityRegion(activeLeft, activeRight, (float)m_chunkMap->GetChunkPixelWidth());
+        m_entityManager.Update(m_fixedStep);
+        m_score += m_entityManager.GetScore();
+        m_entityManager.ResetScore();
+
+        m_chunkMap->Update(m_camera->GetX(), (float)sz.X);
+
+        if (m_player)
         {
-            m_chunkMap->RenderCollisionDebug(m_renderer, m_camera);
-            m_entityManager.RenderCollisionBoxDebug(m_renderer, m_camera);
+            auto* tr = m_player->GetComponent<TransformComponent>();
+            if (tr && tr->worldX < m_camera->GetMaxX()) tr->worldX = m_camera->GetMaxX();
         }
-        
-        m_gameUI->Render(m_renderer, m_score, hp, maxHp);
 
-        t.CapFPS();
-        SDL_RenderPresent(m_renderer->GetRenderer());
+        m_accumulator -= m_fixedStep;
+        ++ticks;
     }
+
+    // Still behind after the cap (a stall or breakpoint): let the game slow down
+    // for this frame rather than owe ever more ticks
+    if (m_accumulator >= m_fixedStep) m_accumulator = fmod(m_accumulator, m_fixedStep);
+
+    m_interpolation = m_accumulator / m_fixedStep;
 }
 
 void GameController::RestartGame()
@@ -238,13 +422,19 @@ void GameController::RestartGame()
         m_chunkMap->GetPlayerSpawnPoint(sx, sy);
 
         auto* t = m_player->GetComponent<TransformComponent>();
-        if (t) { t->worldX = t->baseX = sx; t->worldY = t->baseY = sy; t->mapInstance = 0; }
+        if (t) { t->worldX = t->baseX = sx; t->worldY = t->baseY = sy; t->mapInstance = 0; t->interpolate = false; m_player->MarkChanged<TransformComponent>(); }
 
         auto* m = m_player->GetComponent<MovementComponent>();
         if (m) m->velocityX = m->velocityY = 0;
 
         auto* h = m_player->GetComponent<HealthComponent>();
-        if (h) { h->health = h->maxHealth; h->isDead = h->isFullyDead = h->isInvincible = false; h->deathTimer = h->invincibleTimer = 0; }
+        if (h)
+        {
+            h->health = h->maxHealth;
+            h->isDead = h->isFullyDead = h->isInvincible = false;
+            m_entityManager.GetTimers().Cancel(h->deathEnd);
+            m_entityManager.GetTimers().Cancel(h->invincibleEnd);
+        }
 
         auto* s = m_player->GetComponent<SpriteComponent>();
         if (s) { s->facingRight = true; s->flickering = false; s->flickerCounter = 0; }
@@ -258,5 +448,10 @@ void GameController::RestartGame()
     m_chunkMap->Reset();
     m_camera->Reset();
     m_score = 0;
+    m_accumulator = 0;
+
+    // Nothing from before the restart should be drawn again
+    m_snapshots[0].Clear();
+    m_snapshots[1].Clear();
     m_gameUI->SetState(UIState::Playing);
 }
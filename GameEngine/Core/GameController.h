@@ -4,6 +4,9 @@
 #include "../Core/StandardIncludes.h"
 #include "../Game/EntityManager.h"
 #include "../Game/GameUI.h"
+#include "../Game/RenderSnapshot.h"
+#include "../Core/JobSystem.h"
+#include "../Core/TimeSlicedQueue.h"
 
 class Renderer;
 class InputController;
@@ -18,11 +21,27 @@ public:
 
     void RunGame();
 
+    // Simulation ticks per second, independent of the render frame rate
+    void SetTickRate(int _ticksPerSecond) { m_fixedStep = 1.0f / _ticksPerSecond; }
+    float GetFixedStep() const { return m_fixedStep; }
+
 private:
     void Initialize();
     void ShutDown();
     void HandleInput(SDL_Event& e);
     void RestartGame();
+    void SubscribeAudio();
+    void PlayQueuedSounds();
+
+    // Run as many fixed simulation ticks as the time since the last frame calls for
+    void Simulate(float _frameTime);
+
+    // Advance the game one frame and fill the back snapshot; safe to run on a worker
+    void SimulateFrame(float _frameTime, bool _dead, bool _fullyDead);
+    void DrawSnapshot(const RenderSnapshot& _snapshot);
+    void SwapSnapshots() { m_front = 1 - m_front; }
+    bool CanPipeline();
+    bool DebugOverlaysVisible();
 
     SDL_Event m_event;
     Renderer* m_renderer = nullptr;
@@ -33,6 +52,30 @@ private:
     Camera* m_camera = nullptr;
     GameUI* m_gameUI = nullptr;
     int m_score = 0;
+
+    // Bit per GameEventType raised by the last simulated frame. Set by the event
+    // handlers, wherever SimulateFrame ran; read on the main thread once it is done
+    uint32_t m_queuedSounds = 0;
+
+    // Fixed-step simulation: real time is banked in m_accumulator and spent in
+    // m_fixedStep ticks; whatever is left decides how far to interpolate
+    static constexpr int MAX_TICKS_PER_FRAME = 5;   // Beyond this, drop time instead of spiralling
+    float m_fixedStep = 1.0f / 60.0f;
+    float m_accumulator = 0;
+    float m_interpolation = 1.0f;
+
+    // Frame N is simulated into m_snapshots[1 - m_front] while frame N-1 is drawn
+    // from m_snapshots[m_front]. View sizes are read on the main thread (SDL) and
+    // handed to the simulation
+    RenderSnapshot m_snapshots[2];
+    int m_front = 0;
+    JobCounter m_frameCounter;
+
+    // Bursty simulation work (chunk population/despawn), at most TASK_BUDGET_MS per frame
+    static constexpr float TASK_BUDGET_MS = 2.0f;
+    TimeSlicedQueue m_tasks;
+    Point m_viewSize;
+    Point m_windowSize;
     
     UIState m_previousState = UIState::StartScreen;
     bool m_quit = false;
@@ -0,0 +1,195 @@
+#include "../Core/JobSystem.h"
+
+thread_local unsigned int JobSystem::t_queueIndex = 0;
+
+JobSystem::JobSystem()
+{
+	m_workerCount = 0;
+	m_queued = 0;
+	m_running = false;
+	m_singleThreaded = false;
+	m_queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+}
+
+JobSystem::~JobSystem()
+{
+	Shutdown();
+}
+
+void JobSystem::Initialize(unsigned int _workerCount)
+{
+	Shutdown();
+	for (unsigned int count = 0; count < _workerCount; count++)
+	{
+		m_queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+	}
+
+	m_running = true;
+	for (unsigned int count = 0; count < _workerCount; count++)
+	{
+		m_workers.push_back(std::thread(&JobSystem::WorkerLoop, this, count + 1));
+	}
+	m_workerCount = _workerCount;
+}
+
+void JobSystem::Shutdown()
+{
+	m_workerCount = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_running = false;
+	}
+	m_wake.notify_all();
+	for (auto& worker : m_workers)
+	{
+		worker.join();
+	}
+	m_workers.clear();
+
+	// Anything left in a worker's deque now runs on the main thread
+	for (size_t index = 1; index < m_queues.size(); index++)
+	{
+		for (auto& job : m_queues[index]->jobs)
+		{
+			m_queues[0]->jobs.push_back(std::move(job));
+		}
+	}
+	m_queues.resize(1);
+}
+
+void JobSystem::Submit(std::function<void()> _job, JobCounter* _counter)
+{
+	_counter->pending.fetch_add(1);
+	Push({ std::move(_job), _counter });
+}
+
+void JobSystem::Submit(std::function<void()> _job, JobCounter* _counter, JobCounter* _dependency)
+{
+	_counter->pending.fetch_add(1);
+	{
+		// Park the job on the dependency; whoever finishes its last job queues it
+		std::lock_guard<std::mutex> lock(_dependency->mutex);
+		if (_dependency->pending.load() > 0)
+		{
+			_dependency->continuations.push_back({ std::move(_job), _counter });
+			return;
+		}
+	}
+	Push({ std::move(_job), _counter });
+}
+
+void JobSystem::Wait(JobCounter* _counter)
+{
+	while (_counter->pending.load() > 0)
+	{
+		if (!TryRunOne(IsSingleThreaded() ? 0 : t_queueIndex))
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	// The thread that finished the last job may still be releasing its continuations
+	std::lock_guard<std::mutex> lock(_counter->mutex);
+}
+
+void JobSystem::Push(Job _job)
+{
+	bool singleThreaded = IsSingleThreaded();
+	WorkQueue& queue = *m_queues[singleThreaded ? 0 : t_queueIndex];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back(std::move(_job));
+	}
+	m_queued.fetch_add(1);
+
+	if (!singleThreaded)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_sleepMutex);
+		}
+		m_wake.notify_one();
+	}
+}
+
+bool JobSystem::Pop(unsigned int _queue, Job& _job)
+{
+	WorkQueue& queue = *m_queues[_queue];
+	std::lock_guard<std::mutex> lock(queue.mutex);
+	if (queue.jobs.empty()) return false;
+
+	// Newest first for cache warmth; oldest first when replaying a frame in submit order
+	if (IsSingleThreaded())
+	{
+		_job = std::move(queue.jobs.front());
+		queue.jobs.pop_front();
+	}
+	else
+	{
+		_job = std::move(queue.jobs.back());
+		queue.jobs.pop_back();
+	}
+	m_queued.fetch_sub(1);
+	return true;
+}
+
+bool JobSystem::Steal(unsigned int _thief, Job& _job)
+{
+	size_t count = m_queues.size();
+	for (size_t offset = 1; offset < count; offset++)
+	{
+		WorkQueue& queue = *m_queues[(_thief + offset) % count];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.jobs.empty()) continue;
+
+		_job = std::move(queue.jobs.front());
+		queue.jobs.pop_front();
+		m_queued.fetch_sub(1);
+		return true;
+	}
+	return false;
+}
+
+bool JobSystem::TryRunOne(unsigned int _queue)
+{
+	Job job;
+	if (!Pop(_queue, job) && !Steal(_queue, job)) return false;
+
+	job.task();
+	Finish(job);
+	return true;
+}
+
+void JobSystem::Finish(Job& _job)
+{
+	std::vector<Job> ready;
+	{
+		std::lock_guard<std::mutex> lock(_job.counter->mutex);
+		if (_job.counter->pending.fetch_sub(1) == 1)
+		{
+			ready.swap(_job.counter->continuations);
+		}
+	}
+
+	for (auto& job : ready)
+	{
+		Push(std::move(job));
+	}
+}
+
+bool JobSystem::HasWorkForWorkers()
+{
+	return m_queued.load() > 0 && !m_singleThreaded;
+}
+
+void JobSystem::WorkerLoop(unsigned int _queue)
+{
+	t_queueIndex = _queue;
+	while (true)
+	{
+		if (!m_singleThreaded && TryRunOne(_queue)) continue;
+
+		std::unique_lock<std::mutex> lock(m_sleepMutex);
+		m_wake.wait(lock, [this] { return !m_running || HasWorkForWorkers(); });
+		if (!m_running) return;
+	}
+}
@@ -0,0 +1,116 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include "../Core/StandardIncludes.h"
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+
+struct JobCounter;
+
+struct Job
+{
+	std::function<void()> task;
+	JobCounter* counter;
+};
+
+// Number of submitted jobs that have not finished yet, plus jobs waiting for it to reach zero
+struct JobCounter
+{
+	std::atomic<int> pending{ 0 };
+	std::mutex mutex;
+	std::vector<Job> continuations;
+};
+
+/**
+ * Work-stealing pool of worker threads running small jobs.
+ *
+ * Every worker owns a deque: it pushes and pops its own jobs at the back and
+ * steals from the front of the others when it runs dry. The main thread owns
+ * queue 0 and helps run jobs while it waits on a counter.
+ *
+ * In single-threaded mode (no workers, or SetSingleThreaded(true)) every job
+ * runs on the thread that calls Wait(), in submit order, so a frame runs the
+ * same way every time. Only switch modes while no jobs are in flight.
+ */
+class JobSystem : public Singleton<JobSystem>
+{
+public:
+	//Constructors/ Destructors
+	JobSystem();
+	virtual ~JobSystem();
+
+	//Accessors
+	unsigned int GetWorkerCount() { return m_workerCount; }
+	unsigned int GetThreadCount() { return (unsigned int)m_queues.size(); }
+
+	// 0 on the main thread (and any thread the JobSystem did not start), 1..n on workers
+	static unsigned int GetThreadIndex() { return t_queueIndex; }
+	bool IsSingleThreaded() { return m_singleThreaded || m_workerCount == 0; }
+	void SetSingleThreaded(bool _singleThreaded) { m_singleThreaded = _singleThreaded; }
+
+	//Methods
+	void Initialize(unsigned int _workerCount);
+	void Shutdown();
+
+	// Queue a job; _counter is incremented now and decremented when the job finishes
+	void Submit(std::function<void()> _job, JobCounter* _counter);
+
+	// Queue a job that may only start once _dependency has reached zero
+	void Submit(std::function<void()> _job, JobCounter* _counter, JobCounter* _dependency);
+
+	// Help run queued jobs until _counter reaches zero
+	void Wait(JobCounter* _counter);
+
+	// Call _func(begin, end) over [0, _count) in chunks of _chunkSize and wait for all of them.
+	// Single-threaded it runs the chunks in order on the calling thread.
+	template<typename Func>
+	void ParallelFor(uint32_t _count, uint32_t _chunkSize, const Func& _func)
+	{
+		if (_count <= _chunkSize || IsSingleThreaded())
+		{
+			for (uint32_t begin = 0; begin < _count; begin += _chunkSize)
+				_func(begin, std::min(_count, begin + _chunkSize));
+			return;
+		}
+
+		JobCounter counter;
+		for (uint32_t begin = 0; begin < _count; begin += _chunkSize)
+		{
+			uint32_t end = std::min(_count, begin + _chunkSize);
+			Submit([&_func, begin, end]() { _func(begin, end); }, &counter);
+		}
+		Wait(&counter);
+	}
+
+private:
+	struct WorkQueue
+	{
+		std::deque<Job> jobs;
+		std::mutex mutex;
+	};
+
+	void Push(Job _job);
+	bool Pop(unsigned int _queue, Job& _job);
+	bool Steal(unsigned int _thief, Job& _job);
+	bool TryRunOne(unsigned int _queue);
+	void Finish(Job& _job);
+	void WorkerLoop(unsigned int _queue);
+	bool HasWorkForWorkers();
+
+	std::vector<std::thread> m_workers;
+	std::vector<std::unique_ptr<WorkQueue>> m_queues;	// 0 = main thread, 1..n = workers
+	std::atomic<unsigned int> m_workerCount;
+	std::atomic<int> m_queued;
+	std::mutex m_sleepMutex;
+	std::condition_variable m_wake;
+	std::atomic<bool> m_running;
+	std::atomic<bool> m_singleThreaded;
+
+	static thread_local unsigned int t_queueIndex;
+};
+
+#endif // JOB_SYSTEM_H
@@ -0,0 +1,37 @@
+#include "../Core/TimeSlicedQueue.h"
+
+TimeSlicedQueue::TimeSlicedQueue()
+{
+	m_lastRunTime = 0;
+}
+
+void TimeSlicedQueue::Submit(SlicedTask _task)
+{
+	m_tasks.push_back(std::move(_task));
+}
+
+void TimeSlicedQueue::Run(float _budgetMs)
+{
+	Uint64 start = SDL_GetPerformanceCounter();
+	Uint64 budget = (Uint64)(_budgetMs * 0.001f * SDL_GetPerformanceFrequency());
+
+	do
+	{
+		if (m_tasks.empty()) break;
+
+		// A task may submit more while it runs, so step it before touching the queue
+		bool finished = m_tasks.front()();
+		if (finished) m_tasks.pop_front();
+	}
+	while (SDL_GetPerformanceCounter() - start < budget);
+
+	m_lastRunTime = (float)(SDL_GetPerformanceCounter() - start) * 1000.0f / SDL_GetPerformanceFrequency();
+}
+
+void TimeSlicedQueue::Flush()
+{
+	while (!m_tasks.empty())
+	{
+		if (m_tasks.front()()) m_tasks.pop_front();
+	}
+}
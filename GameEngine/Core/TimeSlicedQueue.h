@@ -0,0 +1,47 @@
+#ifndef TIME_SLICED_QUEUE_H
+#define TIME_SLICED_QUEUE_H
+
+#include "../Core/StandardIncludes.h"
+#include <deque>
+#include <functional>
+
+// One resumable job: each call does a small piece of the work, true once it is finished
+using SlicedTask = std::function<bool()>;
+
+/**
+ * Spreads bursty work (chunk population and despawn, ...) over several frames.
+ *
+ * Run() steps tasks in submit order until the frame's budget is spent, so a
+ * burst of work costs at most the budget per frame instead of one long frame.
+ * At least one step runs per call, so tasks always make progress however the
+ * budget is set. Tasks hold their own state and must check that what they
+ * work on still exists, since the world may change between their steps.
+ *
+ * Not thread-safe: submit and run from the thread that simulates.
+ */
+class TimeSlicedQueue
+{
+public:
+	//Constructors/ Destructors
+	TimeSlicedQueue();
+	virtual ~TimeSlicedQueue() { }
+
+	//Accessors
+	size_t GetPendingCount() { return m_tasks.size(); }
+	float GetLastRunTime() { return m_lastRunTime; }	// Milliseconds spent in the last Run()
+
+	//Methods
+	void Submit(SlicedTask _task);
+
+	// Step tasks until _budgetMs milliseconds have been spent or none are left
+	void Run(float _budgetMs);
+
+	// Run every task to completion
+	void Flush();
+
+private:
+	std::deque<SlicedTask> m_tasks;
+	float m_lastRunTime;
+};
+
+#endif // TIME_SLICED_QUEUE_H
@@ -13,6 +13,7 @@ public:
 	//Accessors
 	unsigned int GetFPS() { return m_fpsLast; }
 	float GetDeltaTime() { return m_deltaTime; }
+	unsigned int GetTargetFPS() { return m_targetFPS; }
 
 	//Methods
 	void Tick();
@@ -0,0 +1,99 @@
+#include "ActivityRegion.h"
+#include "EntityManager.h"
+
+constexpr int ActivityRegion::SWEEP_TICKS;
+
+void ActivityRegion::Set(float _left, float _right, float _cellWidth)
+{
+    m_left = _left;
+    m_right = _right;
+    m_cellWidth = _cellWidth;
+}
+
+bool ActivityRegion::Apply(EntityManager& _manager)
+{
+    if (m_cellWidth <= 0) return false;
+
+    bool moved = m_left != m_sweptLeft || m_right != m_sweptRight;
+    if (!moved && ++m_ticksSinceSweep < SWEEP_TICKS) return false;
+
+    bool changed = Wake(_manager);
+    changed |= Sleep(_manager);
+
+    m_sweptLeft = m_left;
+    m_sweptRight = m_right;
+    m_ticksSinceSweep = 0;
+    return changed;
+}
+
+bool ActivityRegion::Wake(EntityManager& _manager)
+{
+    bool changed = false;
+    int first = CellOf(m_left);
+    int last = CellOf(m_right);
+
+    auto it = m_buckets.begin();
+    while (it != m_buckets.end() && it->first <= last)
+    {
+        // Cells left of the range only shed handles of entities destroyed meanwhile
+        bool wake = it->first >= first;
+        std::vector<EntityID>& bucket = it->second;
+        size_t kept = 0;
+        for (EntityID id : bucket)
+        {
+            Entity* entity = _manager.Get(id);
+            if (!entity || !entity->IsDormant()) continue;
+            if (wake) { entity->SetDormant(false); changed = true; }
+            else bucket[kept++] = id;
+        }
+        m_dormantCount -= (uint32_t)(bucket.size() - kept);
+        bucket.resize(kept);
+
+        if (bucket.empty()) it = m_buckets.erase(it);
+        else ++it;
+    }
+    return changed;
+}
+
+bool ActivityRegion::Sleep(EntityManager& _manager)
+{
+    bool changed = false;
+    ComponentID playerTag = ComponentTypeID<PlayerTag>::value;
+
+    // Only rows in use (active and awake); rows are not reordered until the next partition
+    for (Archetype* archetype : _manager.GetStorage().GetQuery(MakeSignature<TransformComponent>()))
+    {
+        if (archetype->Has(playerTag)) continue;
+        auto* transforms = archetype->GetColumn<TransformComponent>();
+
+        for (uint32_t i = 0; i < archetype->GetActiveCount(); ++i)
+        {
+            const TransformComponent* transform = transforms->Get(i);
+            float right = transform->worldX + transform->width * transform->scale;
+            if (right >= m_left && transform->worldX <= m_right) continue;
+
+            Entity* entity = archetype->GetEntity(i);
+            entity->SetDormant(true);
+            m_buckets[CellOf(transform->worldX)].push_back(entity->GetID());
+            ++m_dormantCount;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+void ActivityRegion::Clear(EntityManager& _manager)
+{
+    for (auto& bucket : m_buckets)
+    {
+        for (EntityID id : bucket.second)
+        {
+            Entity* entity = _manager.Get(id);
+            if (entity) entity->SetDormant(false);
+        }
+    }
+    m_buckets.clear();
+    m_dormantCount = 0;
+    m_cellWidth = 0;
+    m_ticksSinceSweep = 0;
+}
@@ -0,0 +1,55 @@
+#ifndef ACTIVITY_REGION_H
+#define ACTIVITY_REGION_H
+
+#include "Entity.h"
+#include <map>
+
+class EntityManager;
+
+/**
+ * Keeps entities outside a world-space x range dormant.
+ *
+ * Dormant entities sit past their archetype's active rows, so every system,
+ * view and the spatial grid skip them without testing each one. The range is
+ * set from the camera and ChunkMap's chunk bounds; entities that leave it are
+ * parked in a bucket per cell (chunk width) of their x position, and a cell's
+ * bucket is woken in one go when the range reaches it again. Dormant entities
+ * do not move, so the bucket stays accurate.
+ *
+ * Awake entities are checked against the range only when it moves, and every
+ * SWEEP_TICKS ticks to catch newly spawned or repositioned ones. The player is
+ * never made dormant.
+ */
+class ActivityRegion
+{
+public:
+    // World x range [_left, _right] to keep awake, _cellWidth wide wake buckets
+    void Set(float _left, float _right, float _cellWidth);
+
+    // Sleep and wake entities for the current range; true if any changed.
+    // Call at a sync point, then repartition before systems run.
+    bool Apply(EntityManager& _manager);
+
+    // Wake every dormant entity and forget the range (world reset)
+    void Clear(EntityManager& _manager);
+
+    uint32_t GetDormantCount() const { return m_dormantCount; }
+
+private:
+    static constexpr int SWEEP_TICKS = 8;
+
+    int CellOf(float _x) const { return (int)floor(_x / m_cellWidth); }
+    bool Sleep(EntityManager& _manager);
+    bool Wake(EntityManager& _manager);
+
+    float m_left = 0;
+    float m_right = 0;
+    float m_cellWidth = 0;
+    float m_sweptLeft = 0;
+    float m_sweptRight = 0;
+    int m_ticksSinceSweep = 0;
+    uint32_t m_dormantCount = 0;    // Entities parked in m_buckets, some may since have been destroyed
+    std::map<int, std::vector<EntityID>> m_buckets;  // Cell -> dormant entities
+};
+
+#endif // ACTIVITY_REGION_H
@@ -0,0 +1,239 @@
+#include "Archetype.h"
+#include "Entity.h"
+
+Archetype::Archetype(std::vector<std::unique_ptr<ComponentColumn>> _columns)
+    : m_columns(std::move(_columns))
+{
+    m_columnIndex.fill(-1);
+    m_addEdges.fill(nullptr);
+    m_removeEdges.fill(nullptr);
+
+    for (size_t i = 0; i < m_columns.size(); ++i)
+    {
+        ComponentID id = m_columns[i]->GetID();
+        m_signature.set(id);
+        m_columnIndex[id] = static_cast<int8_t>(i);
+    }
+}
+
+void EntityIndex::Insert(Entity* _entity)
+{
+    uint32_t index = GetEntityIndex(_entity->GetID());
+    if (index >= m_sparse.size()) m_sparse.resize(index + 1);
+    m_sparse[index] = static_cast<uint32_t>(m_entities.size());
+    m_entities.push_back(_entity);
+}
+
+void EntityIndex::Remove(Entity* _entity)
+{
+    // Swap-and-pop, patching the moved entity's slot
+    uint32_t slot = m_sparse[GetEntityIndex(_entity->GetID())];
+    Entity* last = m_entities.back();
+    m_entities[slot] = last;
+    m_sparse[GetEntityIndex(last->GetID())] = slot;
+    m_entities.pop_back();
+}
+
+void EntityIndex::Clear()
+{
+    m_entities.clear();
+}
+
+ArchetypeStorage::ArchetypeStorage()
+{
+    m_emptyArchetype = FindOrCreate({});
+}
+
+ArchetypeStorage::~ArchetypeStorage()
+{
+    m_lookup.clear();
+    m_archetypes.clear();
+}
+
+void ArchetypeStorage::AddEntity(Entity* _entity)
+{
+    PushRow(m_emptyArchetype, _entity);
+}
+
+void ArchetypeStorage::RemoveEntity(Entity* _entity)
+{
+    if (!_entity->m_archetype) return;
+
+    ComponentSignature indexed = _entity->m_archetype->GetSignature() & m_indexed;
+    for (ComponentID id = 0; indexed.any(); ++id)
+    {
+        if (!indexed.test(id)) continue;
+        m_indices[id].Remove(_entity);
+        indexed.reset(id);
+    }
+
+    RemoveRow(_entity->m_archetype, _entity->m_row);
+    ++m_membershipVersion;
+    _entity->m_archetype = nullptr;
+    _entity->m_row = 0;
+}
+
+Archetype* ArchetypeStorage::FindOrCreateWith(Archetype* _source, std::unique_ptr<ComponentColumn> _newColumn)
+{
+    std::vector<std::unique_ptr<ComponentColumn>> columns;
+    for (const auto& column : _source->m_columns)
+        columns.push_back(column->CreateEmpty());
+    columns.push_back(std::move(_newColumn));
+    return FindOrCreate(std::move(columns));
+}
+
+Archetype* ArchetypeStorage::FindOrCreateWithout(Archetype* _source, ComponentID _id)
+{
+    std::vector<std::unique_ptr<ComponentColumn>> columns;
+    for (const auto& column : _source->m_columns)
+        if (column->GetID() != _id) columns.push_back(column->CreateEmpty());
+    return FindOrCreate(std::move(columns));
+}
+
+Archetype* ArchetypeStorage::FindOrCreate(std::vector<std::unique_ptr<ComponentColumn>> _columns)
+{
+    ComponentSignature signature;
+    for (const auto& column : _columns)
+        signature.set(column->GetID());
+
+    auto it = m_lookup.find(signature.to_ulong());
+    if (it != m_lookup.end()) return it->second;
+
+    Archetype* archetype = new Archetype(std::move(_columns));
+    m_lookup[signature.to_ulong()] = archetype;
+    m_archetypes.push_back(std::unique_ptr<Archetype>(archetype));
+
+    // Keep cached queries up to date
+    for (auto& query : m_queries)
+        if (archetype->Matches(ComponentSignature(query.first))) query.second.push_back(archetype);
+
+    return archetype;
+}
+
+void ArchetypeStorage::IndexComponents(const ComponentSignature& _signature)
+{
+    for (ComponentID id = 0; id < MAX_COMPONENTS; ++id)
+    {
+        if (!_signature.test(id) || m_indexed.test(id)) continue;
+        m_indexed.set(id);
+
+        m_indices[id].Clear();
+        for (const auto& archetype : m_archetypes)
+            if (archetype->Has(id))
+                for (Entity* entity : archetype->m_entities) m_indices[id].Insert(entity);
+    }
+}
+
+const std::vector<Archetype*>& ArchetypeStorage::GetQuery(const ComponentSignature& _signature)
+{
+    std::lock_guard<std::mutex> lock(m_queryMutex);
+    auto it = m_queries.find(_signature.to_ulong());
+    if (it != m_queries.end()) return it->second;
+
+    std::vector<Archetype*>& matches = m_queries[_signature.to_ulong()];
+    for (const auto& archetype : m_archetypes)
+        if (archetype->Matches(_signature)) matches.push_back(archetype.get());
+    return matches;
+}
+
+void ArchetypeStorage::MoveEntity(Entity* _entity, Archetype* _target)
+{
+    Archetype* source = _entity->m_archetype;
+    uint32_t sourceRow = _entity->m_row;
+
+    for (auto& column : _target->m_columns)
+    {
+        ComponentColumn* sourceColumn = source->GetColumn(column->GetID());
+        if (sourceColumn) column->PushFrom(*sourceColumn, sourceRow);
+    }
+
+    RemoveRow(source, sourceRow);
+    PushRow(_target, _entity);
+}
+
+void ArchetypeStorage::SetActive(Entity* _entity, bool _active)
+{
+    if (_entity->m_isActive == _active) return;
+    _entity->m_isActive = _active;
+    if (_active) ++m_membershipVersion;
+
+    if (_entity->m_archetype) _entity->m_archetype->m_partitioned = false;
+}
+
+void ArchetypeStorage::SetDormant(Entity* _entity, bool _dormant)
+{
+    if (_entity->m_isDormant == _dormant) return;
+    _entity->m_isDormant = _dormant;
+    ++m_membershipVersion;
+
+    if (_entity->m_archetype) _entity->m_archetype->m_partitioned = false;
+}
+
+uint32_t ArchetypeStorage::PartitionActive(Archetype* _archetype)
+{
+    if (_archetype->m_partitioned) return _archetype->m_activeCount;
+
+    uint32_t front = 0;
+    uint32_t back = _archetype->GetCount();
+    while (true)
+    {
+        while (front < back && _archetype->m_entities[front]->IsActive()) ++front;
+        while (front < back && !_archetype->m_entities[back - 1]->IsActive()) --back;
+        if (front >= back) break;
+        SwapRows(_archetype, front++, --back);
+    }
+
+    _archetype->m_activeCount = front;
+    _archetype->m_partitioned = true;
+    return front;
+}
+
+void ArchetypeStorage::PartitionAll()
+{
+    for (auto& archetype : m_archetypes)
+        PartitionActive(archetype.get());
+}
+
+void ArchetypeStorage::PushRow(Archetype* _archetype, Entity* _entity)
+{
+    _archetype->m_entities.push_back(_entity);
+    _entity->m_archetype = _archetype;
+    _entity->m_row = _archetype->GetCount() - 1;
+
+    // Inactive rows belong at the end anyway
+    if (!_entity->IsActive() || !_archetype->m_partitioned) return;
+    if (_archetype->m_activeCount == _entity->m_row) ++_archetype->m_activeCount;
+    else _archetype->m_partitioned = false;
+}
+
+void ArchetypeStorage::RemoveRow(Archetype* _archetype, uint32_t _row)
+{
+    for (auto& column : _archetype->m_columns)
+        column->SwapRemove(_row);
+
+    uint32_t last = _archetype->GetCount() - 1;
+
+    // Removing an active row pulls the last row into the active range
+    if (_archetype->m_partitioned && _row < _archetype->m_activeCount)
+    {
+        if (_archetype->m_activeCount != last + 1) _archetype->m_partitioned = false;
+        --_archetype->m_activeCount;
+    }
+    if (_row != last)
+    {
+        Entity* moved = _archetype->m_entities[last];
+        _archetype->m_entities[_row] = moved;
+        moved->m_row = _row;
+    }
+    _archetype->m_entities.pop_back();
+}
+
+void ArchetypeStorage::SwapRows(Archetype* _archetype, uint32_t _a, uint32_t _b)
+{
+    for (auto& column : _archetype->m_columns)
+        column->SwapRows(_a, _b);
+
+    std::swap(_archetype->m_entities[_a], _archetype->m_entities[_b]);
+    _archetype->m_entities[_a]->m_row = _a;
+    _archetype->m_entities[_b]->m_row = _b;
+}
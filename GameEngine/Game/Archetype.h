@@ -0,0 +1,381 @@
+#ifndef ARCHETYPE_H
+#define ARCHETYPE_H
+
+#include "../Core/StandardIncludes.h"
+#include "../Utils/PoolAllocator.h"
+#include <memory>
+#include <new>
+#include <bitset>
+#include <array>
+#include <unordered_map>
+#include <type_traits>
+#include <mutex>
+
+class Entity;
+
+// Components per column block. Blocks never move once allocated, so a component
+// pointer stays valid while other entities join or leave the same archetype.
+constexpr uint32_t COMPONENT_BLOCK_SIZE = 64;
+
+// Column blocks per slab in each component type's block pool
+constexpr size_t COMPONENT_BLOCKS_PER_SLAB = 4;
+
+using ComponentID = uint8_t;
+constexpr size_t MAX_COMPONENTS = 32;
+
+// One bit per component type an entity/archetype has
+using ComponentSignature = std::bitset<MAX_COMPONENTS>;
+
+// Compile-time list of component types; a type's ID is its index in the list
+template<typename... Ts>
+struct ComponentList {};
+
+template<typename T, typename List>
+struct ComponentIndex;
+
+template<typename T, typename... Rest>
+struct ComponentIndex<T, ComponentList<T, Rest...>>
+    : std::integral_constant<ComponentID, 0> {};
+
+template<typename T, typename U, typename... Rest>
+struct ComponentIndex<T, ComponentList<U, Rest...>>
+    : std::integral_constant<ComponentID, 1 + ComponentIndex<T, ComponentList<Rest...>>::value> {};
+
+// ComponentTypeID<T>::value - defined in Components.h from the registered component list
+template<typename T>
+struct ComponentTypeID;
+
+// Views name a component const to say they only read it; same ID as T
+template<typename T>
+struct ComponentTypeID<const T> : ComponentTypeID<T> {};
+
+// Signature with the bits of every listed component set
+template<typename... Ts>
+ComponentSignature MakeSignature()
+{
+    ComponentSignature signature;
+    int expand[] = { 0, (signature.set(ComponentTypeID<Ts>::value), 0)... };
+    (void)expand;
+    return signature;
+}
+
+/**
+ * Type-erased column holding one component type for every entity of an archetype.
+ * Row i of every column in an archetype belongs to the same entity.
+ *
+ * Each row also carries the storage tick at which its component was last added
+ * or written, so consumers can skip entities whose component has not changed.
+ * Ticks travel with the component when rows move or entities change archetype.
+ */
+class ComponentColumn
+{
+public:
+    virtual ~ComponentColumn() = default;
+
+    virtual ComponentID GetID() const = 0;
+
+    // Create an empty column of the same component type
+    virtual std::unique_ptr<ComponentColumn> CreateEmpty() const = 0;
+
+    // Move row _srcRow of _src (same component type) onto the end of this column
+    virtual void PushFrom(ComponentColumn& _src, uint32_t _srcRow) = 0;
+
+    // Destroy row _row and fill the hole with the last row
+    virtual void SwapRemove(uint32_t _row) = 0;
+
+    // Exchange the components of two rows
+    virtual void SwapRows(uint32_t _a, uint32_t _b) = 0;
+
+    uint32_t GetCount() const { return m_count; }
+
+    // Tick of the last add/write of row _row (see ArchetypeStorage::GetTick)
+    uint32_t GetChangeTick(uint32_t _row) const { return m_changeTicks[_row]; }
+    void MarkChanged(uint32_t _row, uint32_t _tick) { m_changeTicks[_row] = _tick; }
+    void MarkChanged(uint32_t _begin, uint32_t _end, uint32_t _tick)
+    {
+        std::fill(m_changeTicks.begin() + _begin, m_changeTicks.begin() + _end, _tick);
+    }
+
+protected:
+    uint32_t m_count = 0;
+    std::vector<uint32_t> m_changeTicks;   // Row -> change tick
+};
+
+/**
+ * Column of T stored contiguously in fixed-size blocks.
+ * Systems walk a column block by block for cache-friendly iteration.
+ * Blocks come from the storage's pool for T, shared by every archetype's
+ * column of T, so entities moving between archetypes recycle blocks.
+ */
+template<typename T>
+class TypedColumn : public ComponentColumn
+{
+public:
+    explicit TypedColumn(FixedBlockPool* _pool) : m_pool(_pool) {}
+    TypedColumn(const TypedColumn&) = delete;
+    TypedColumn& operator=(const TypedColumn&) = delete;
+
+    ~TypedColumn() override
+    {
+        for (uint32_t row = 0; row < m_count; ++row) Get(row)->~T();
+        for (T* block : m_blocks) m_pool->Free(block);
+    }
+
+    ComponentID GetID() const override { return ComponentTypeID<T>::value; }
+
+    std::unique_ptr<ComponentColumn> CreateEmpty() const override
+    {
+        return std::unique_ptr<ComponentColumn>(new TypedColumn<T>(m_pool));
+    }
+
+    T* Get(uint32_t _row) { return &m_blocks[_row / COMPONENT_BLOCK_SIZE][_row % COMPONENT_BLOCK_SIZE]; }
+    T* GetBlock(uint32_t _block) { return m_blocks[_block]; }
+
+    template<typename... Args>
+    T* Emplace(Args&&... _args)
+    {
+        if (m_count == m_blocks.size() * COMPONENT_BLOCK_SIZE)
+            m_blocks.push_back(static_cast<T*>(m_pool->Allocate()));
+
+        T* slot = Get(m_count);
+        new (slot) T(std::forward<Args>(_args)...);
+        m_changeTicks.push_back(0);
+        ++m_count;
+        return slot;
+    }
+
+    void PushFrom(ComponentColumn& _src, uint32_t _srcRow) override
+    {
+        Emplace(std::move(*static_cast<TypedColumn<T>&>(_src).Get(_srcRow)));
+        m_changeTicks.back() = _src.GetChangeTick(_srcRow);
+    }
+
+    void SwapRemove(uint32_t _row) override
+    {
+        uint32_t last = m_count - 1;
+        if (_row != last)
+        {
+            *Get(_row) = std::move(*Get(last));
+            m_changeTicks[_row] = m_changeTicks[last];
+        }
+        Get(last)->~T();
+        m_changeTicks.pop_back();
+        --m_count;
+
+        // Keep one spare block so a row flipping in and out does not thrash the pool
+        if (m_blocks.size() * COMPONENT_BLOCK_SIZE - m_count >= 2 * COMPONENT_BLOCK_SIZE)
+        {
+            m_pool->Free(m_blocks.back());
+            m_blocks.pop_back();
+        }
+    }
+
+    void SwapRows(uint32_t _a, uint32_t _b) override
+    {
+        std::swap(*Get(_a), *Get(_b));
+        std::swap(m_changeTicks[_a], m_changeTicks[_b]);
+    }
+
+private:
+    FixedBlockPool* m_pool;
+    std::vector<T*> m_blocks;
+};
+
+/**
+ * Archetype = the set of entities sharing exactly the same component types.
+ *
+ * Each component type gets its own column (SoA layout), so a system touching
+ * Transform + Movement streams through two dense arrays instead of chasing
+ * one heap-allocated component per entity.
+ *
+ * Active entities (not inactive, not dormant) are kept in rows [0, active count)
+ * so views can walk the active range without testing each entity. SetActive only flags the entity and
+ * marks the archetype unpartitioned; rows are reordered by ArchetypeStorage::PartitionAll
+ * at EntityManager's sync points, never while systems may be iterating.
+ */
+class Archetype
+{
+public:
+    Archetype(std::vector<std::unique_ptr<ComponentColumn>> _columns);
+
+    const ComponentSignature& GetSignature() const { return m_signature; }
+    bool Has(ComponentID _id) const { return m_signature.test(_id); }
+
+    uint32_t GetCount() const { return static_cast<uint32_t>(m_entities.size()); }
+    uint32_t GetActiveCount() const { return m_activeCount; }   // As of the last partition
+    uint32_t GetBlockCount() const { return (GetCount() + COMPONENT_BLOCK_SIZE - 1) / COMPONENT_BLOCK_SIZE; }
+    Entity* GetEntity(uint32_t _row) const { return m_entities[_row]; }
+
+    ComponentColumn* GetColumn(ComponentID _id) const
+    {
+        int index = m_columnIndex[_id];
+        return index >= 0 ? m_columns[index].get() : nullptr;
+    }
+
+    // Typed column access, nullptr if this archetype does not store T
+    template<typename T>
+    TypedColumn<T>* GetColumn() const
+    {
+        return static_cast<TypedColumn<T>*>(GetColumn(ComponentTypeID<T>::value));
+    }
+
+    // True if this archetype stores every component in _signature
+    bool Matches(const ComponentSignature& _signature) const { return (m_signature & _signature) == _signature; }
+
+private:
+    friend class ArchetypeStorage;
+
+    ComponentSignature m_signature;
+    std::vector<std::unique_ptr<ComponentColumn>> m_columns;
+    std::array<int8_t, MAX_COMPONENTS> m_columnIndex;          // Component ID -> column, -1 if absent
+    std::vector<Entity*> m_entities;                            // Row -> owning entity
+    uint32_t m_activeCount = 0;                                 // Rows [0, m_activeCount) are active
+    bool m_partitioned = true;                                  // False until PartitionActive runs
+
+    // Cached transitions to the archetype reached by adding/removing one component
+    std::array<Archetype*, MAX_COMPONENTS> m_addEdges;
+    std::array<Archetype*, MAX_COMPONENTS> m_removeEdges;
+};
+
+/**
+ * Unordered set of the entities that have one component, kept by ArchetypeStorage
+ * for tag and singleton components (PlayerTag, EnemyComponent, ...).
+ *
+ * Sparse set keyed by the entity's handle index, so insert, remove and
+ * membership are O(1) and the dense list can be walked directly.
+ */
+class EntityIndex
+{
+public:
+    void Insert(Entity* _entity);
+    void Remove(Entity* _entity);
+    void Clear();
+
+    // Members, active or not, in no particular order
+    const std::vector<Entity*>& GetEntities() const { return m_entities; }
+    Entity* GetFirst() const { return m_entities.empty() ? nullptr : m_entities.front(); }
+
+private:
+    std::vector<Entity*> m_entities;
+    std::vector<uint32_t> m_sparse;   // Handle index -> slot in m_entities
+};
+
+/**
+ * Owns all archetypes and moves entities between them when their component set changes.
+ * Lives behind EntityManager; Entity::AddComponent/RemoveComponent forward here.
+ *
+ * Queries (a signature plus its matching archetypes) are cached. New archetypes only
+ * appear from AddComponent/RemoveComponent, so that is the only time the lists change.
+ *
+ * The tick counts frames (EntityManager advances it after each Update). Adding a
+ * component, writing it through a view, or Entity::MarkChanged<T>() stamps the row
+ * with the current tick; a consumer remembers the tick it last caught up to and
+ * asks for rows stamped after it (ComponentView::EachChanged).
+ *
+ * Components passed to IndexComponents() additionally get an EntityIndex, updated
+ * as the component is added and removed, so "the player" or "every enemy" is a
+ * list lookup rather than a search.
+ */
+class ArchetypeStorage
+{
+public:
+    ArchetypeStorage();
+    ~ArchetypeStorage();
+
+    // Place a new entity in the empty archetype
+    void AddEntity(Entity* _entity);
+
+    // Destroy all components of an entity and detach it
+    void RemoveEntity(Entity* _entity);
+
+    template<typename T, typename... Args>
+    T* AddComponent(Entity* _entity, Args&&... _args);
+
+    template<typename T>
+    void RemoveComponent(Entity* _entity);
+
+    // Flip an entity's active flag. Views see the change after the next PartitionAll.
+    void SetActive(Entity* _entity, bool _active);
+
+    // Park an entity outside every view without touching its active flag, or wake
+    // it. Like SetActive, takes effect at the next PartitionAll.
+    void SetDormant(Entity* _entity, bool _dormant);
+
+    // Move active rows to the front if needed and return how many there are.
+    // Must not be called while rows of _archetype are being iterated.
+    uint32_t PartitionActive(Archetype* _archetype);
+
+    // Partition every archetype whose active set changed (sync point only)
+    void PartitionAll();
+
+    uint32_t GetTick() const { return m_tick; }
+    void AdvanceTick() { ++m_tick; }
+
+    // Bumped whenever an entity is removed, loses a component, is reactivated or
+    // changes dormancy.
+    // Consumers that track entities incrementally (e.g. the spatial grid) resync then.
+    uint32_t GetMembershipVersion() const { return m_membershipVersion; }
+
+    // Keep an EntityIndex for each component in _signature, starting with the
+    // entities that already have it
+    void IndexComponents(const ComponentSignature& _signature);
+
+    // Every entity with T, active or not. T must have been passed to IndexComponents().
+    template<typename T>
+    const std::vector<Entity*>& GetIndexed() const { return m_indices[ComponentTypeID<T>::value].GetEntities(); }
+
+    // The entity with singleton T (e.g. PlayerTag), nullptr if there is none
+    template<typename T>
+    Entity* GetSingleton() const { return m_indices[ComponentTypeID<T>::value].GetFirst(); }
+
+    // All archetypes in creation order
+    const std::vector<std::unique_ptr<Archetype>>& GetArchetypes() const { return m_archetypes; }
+
+    // Archetypes storing every component in _signature. The returned list stays
+    // valid for the storage's lifetime and grows as matching archetypes are created.
+    // Safe to call from several systems at once.
+    const std::vector<Archetype*>& GetQuery(const ComponentSignature& _signature);
+
+private:
+    Archetype* FindOrCreateWith(Archetype* _source, std::unique_ptr<ComponentColumn> _newColumn);
+    Archetype* FindOrCreateWithout(Archetype* _source, ComponentID _id);
+    Archetype* FindOrCreate(std::vector<std::unique_ptr<ComponentColumn>> _columns);
+
+    // Move an entity's shared components into _target. Columns _target has but the
+    // source lacks are left one row short for the caller to fill.
+    void MoveEntity(Entity* _entity, Archetype* _target);
+
+    // Append an entity as the last row of _archetype
+    void PushRow(Archetype* _archetype, Entity* _entity);
+
+    // Block pool for T's columns, created on first use
+    template<typename T>
+    FixedBlockPool* GetBlockPool();
+
+    // Swap-remove a row from an archetype and patch the entity moved into it
+    void RemoveRow(Archetype* _archetype, uint32_t _row);
+
+    // Exchange two rows of an archetype, components and entities
+    void SwapRows(Archetype* _archetype, uint32_t _a, uint32_t _b);
+
+    std::array<std::unique_ptr<FixedBlockPool>, MAX_COMPONENTS> m_blockPools;   // Outlive m_archetypes
+    std::vector<std::unique_ptr<Archetype>> m_archetypes;
+    std::unordered_map<unsigned long, Archetype*> m_lookup;                 // Signature -> archetype
+    std::unordered_map<unsigned long, std::vector<Archetype*>> m_queries;   // Signature -> matches
+    std::mutex m_queryMutex;
+    Archetype* m_emptyArchetype;
+    uint32_t m_tick = 1;
+    uint32_t m_membershipVersion = 0;
+    ComponentSignature m_indexed;                                  // Components with an EntityIndex
+    std::array<EntityIndex, MAX_COMPONENTS> m_indices;
+};
+
+template<typename T>
+FixedBlockPool* ArchetypeStorage::GetBlockPool()
+{
+    std::unique_ptr<FixedBlockPool>& pool = m_blockPools[ComponentTypeID<T>::value];
+    if (!pool) pool.reset(new FixedBlockPool(sizeof(T) * COMPONENT_BLOCK_SIZE, COMPONENT_BLOCKS_PER_SLAB));
+    return pool.get();
+}
+
+#endif // ARCHETYPE_H
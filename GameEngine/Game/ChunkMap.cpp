@@ -2,9 +2,12 @@
 #include "../Graphics/Renderer.h"
 #include "../Game/EntityManager.h"
 #include "../Core/Timing.h"
+#include "../Core/TimeSlicedQueue.h"
 
 ChunkMap::ChunkMap()
     : m_entityManager(nullptr)
+    , m_tasks(nullptr)
+    , m_nextSerial(1)
     , m_startChunk(nullptr)
     , m_nextChunkX(0.0f)
     , m_chunkWidth(0)
@@ -88,10 +91,9 @@ void ChunkMap::AddBackgroundLayer(const string& _path, float _parallaxFactor)
     }
 }
 
-void ChunkMap::RenderBackgrounds(Renderer* _renderer, Camera* _camera)
+void ChunkMap::RenderBackgrounds(Renderer* _renderer, float _cameraX, bool _farthestOnly)
 {
     SDL_Renderer* sdl = _renderer->GetRenderer();
-    float cameraX = _camera ? _camera->GetX() : 0.0f;
     
     Point logicalSize = _renderer->GetLogicalSize();
     int screenWidth = logicalSize.X;
@@ -100,6 +102,7 @@ void ChunkMap::RenderBackgrounds(Renderer* _renderer, Camera* _camera)
     for (const auto& layer : m_backgroundLayers)
     {
         if (!layer.texture || layer.width == 0) continue;
+        if (_farthestOnly && &layer != &m_backgroundLayers.front()) break;
         
         float scale = (float)screenHeight / (float)layer.height;
         int scaledWidth = (int)(layer.width * scale);
@@ -107,7 +110,7 @@ void ChunkMap::RenderBackgrounds(Renderer* _renderer, Camera* _camera)
         
         if (scaledWidth == 0) continue;
         
-        float parallaxOffset = cameraX * layer.parallaxFactor;
+        float parallaxOffset = _cameraX * layer.parallaxFactor;
         float offset = fmod(parallaxOffset, (float)scaledWidth);
         float startX = -offset;
         
@@ -154,7 +157,15 @@ void ChunkMap::Update(float _cameraX, float _screenWidth)
     {
         if (it->worldOffsetX + m_chunkWidth < despawnThreshold && it->chunkType != 0)
         {
-            CleanupChunkEntities(*it);
+            if (m_tasks)
+            {
+                QueueCleanupEntities(std::move(it->entities));
+            }
+            else
+            {
+                CleanupChunkEntities(*it);
+                m_spareEntityLists.push_back(std::move(it->entities));
+            }
             it = m_activeChunks.erase(it);
         }
         else
@@ -167,14 +178,25 @@ void ChunkMap::Update(float _cameraX, float _screenWidth)
 void ChunkMap::SpawnNextChunk()
 {
     ChunkInstance newChunk;
+    newChunk.serial = m_nextSerial++;
     newChunk.worldOffsetX = m_nextChunkX;
     newChunk.chunkType = SelectRandomChunkType();
     newChunk.tileMap = SelectRandomChunkVariant(newChunk.chunkType);
     
     if (newChunk.tileMap)
     {
-        SpawnEntitiesForChunk(newChunk);
-        m_activeChunks.push_back(newChunk);
+        // Reuse a despawned chunk's entity list to avoid reallocating it
+        if (!m_spareEntityLists.empty())
+        {
+            newChunk.entities = std::move(m_spareEntityLists.back());
+            m_spareEntityLists.pop_back();
+        }
+        // Tiles are there at once; the entities may follow over a few frames,
+        // well before the chunk (spawned a chunk ahead of the view) is reached
+        uint32_t serial = newChunk.serial;
+        if (!m_tasks) SpawnEntitiesForChunk(newChunk);
+        m_activeChunks.push_back(std::move(newChunk));
+        if (m_tasks) QueueSpawnEntities(serial);
     }
     
     m_nextChunkX += m_chunkWidth;
@@ -215,114 +237,165 @@ void ChunkMap::SpawnEntitiesForChunk(ChunkInstance& _chunk)
 {
     if (!_chunk.tileMap || !m_entityManager) return;
     
-    // Spawn coins
-    const auto& coinZones = _chunk.tileMap->GetCoinSpawnZones();
-    for (const auto& zone : coinZones)
+    for (const auto& zone : _chunk.tileMap->GetCoinSpawnZones())
+        SpawnCoinZone(_chunk, zone);
+    for (const auto& zone : _chunk.tileMap->GetEnemySpawnZones())
+        SpawnEnemyZone(_chunk, zone);
+}
+
+void ChunkMap::SpawnCoinZone(ChunkInstance& _chunk, const CoinSpawnZone& _zone)
+{
+    // Recorded now, created at the next sync point (ApplyCommands when run as a queued step)
+    EntityCommandBuffer& commands = m_entityManager->GetCommandBuffer();
+    
+    if (m_floatDist(m_rng) > _zone.chance) return;
+    
+    int count = _zone.minCount;
+    if (_zone.maxCount > _zone.minCount)
     {
-        if (m_floatDist(m_rng) > zone.chance) continue;
+        std::uniform_int_distribution<int> countDist(_zone.minCount, _zone.maxCount);
+        count = countDist(m_rng);
+    }
+    
+    for (int i = 0; i < count; ++i)
+    {
+        float coinWidth = 16.0f;
+        float coinHeight = 16.0f;
+        std::uniform_real_distribution<float> xDist(_zone.x + coinWidth * 0.5f, _zone.x + _zone.width - coinWidth * 0.5f);
+        std::uniform_real_distribution<float> yDist(_zone.y + coinHeight, _zone.y + _zone.height);
         
-        int count = zone.minCount;
-        if (zone.maxCount > zone.minCount)
-        {
-            std::uniform_int_distribution<int> countDist(zone.minCount, zone.maxCount);
-            count = countDist(m_rng);
-        }
+        float localX = xDist(m_rng);
+        float localY = yDist(m_rng);
+        float worldX = localX + _chunk.worldOffsetX;
+        float worldY = localY;
         
-        for (int i = 0; i < count; ++i)
-        {
-            float coinWidth = 16.0f;
-            float coinHeight = 16.0f;
-            std::uniform_real_distribution<float> xDist(zone.x + coinWidth * 0.5f, zone.x + zone.width - coinWidth * 0.5f);
-            std::uniform_real_distribution<float> yDist(zone.y + coinHeight, zone.y + zone.height);
-            
-            float localX = xDist(m_rng);
-            float localY = yDist(m_rng);
-            float worldX = localX + _chunk.worldOffsetX;
-            float worldY = localY;
-            
-            Entity* coin = EntityFactory::CreateRandomCoin(worldX, worldY);
-            m_entityManager->GetAllEntities().push_back(coin);
-            _chunk.entities.push_back(coin);
-        }
+        _chunk.entities.push_back(EntityFactory::CreateRandomCoin(commands, worldX, worldY));
     }
+}
+
+void ChunkMap::SpawnEnemyZone(ChunkInstance& _chunk, const EnemySpawnZone& _zone)
+{
+    EntityCommandBuffer& commands = m_entityManager->GetCommandBuffer();
     
-    // Spawn enemies
-    const auto& enemyZones = _chunk.tileMap->GetEnemySpawnZones();
-    for (const auto& zone : enemyZones)
+    if (m_floatDist(m_rng) > _zone.chance) return;
+    
+    for (int i = 0; i < _zone.maxCount; ++i)
     {
-        if (m_floatDist(m_rng) > zone.chance) continue;
+        float enemyWidth = 16.0f;
+        std::uniform_real_distribution<float> xDist(_zone.x + enemyWidth * 0.5f, _zone.x + _zone.width - enemyWidth * 0.5f);
+        
+        float localX = xDist(m_rng);
+        float localY = _zone.y + _zone.height;
+        float worldX = localX + _chunk.worldOffsetX;
+        float worldY = localY;
         
-        for (int i = 0; i < zone.maxCount; ++i)
+        EnemyVariant enemyVariant = EnemyVariant::Ghost;
+        if (!_zone.enemyTypes.empty() && !_zone.enemyWeights.empty())
         {
-            float enemyWidth = 16.0f;
-            std::uniform_real_distribution<float> xDist(zone.x + enemyWidth * 0.5f, zone.x + zone.width - enemyWidth * 0.5f);
-            
-            float localX = xDist(m_rng);
-            float localY = zone.y + zone.height;
-            float worldX = localX + _chunk.worldOffsetX;
-            float worldY = localY;
-            
-            EnemyVariant enemyVariant = EnemyVariant::Ghost;
-            if (!zone.enemyTypes.empty() && !zone.enemyWeights.empty())
+            float weightRoll = m_floatDist(m_rng);
+            float cumulative = 0.0f;
+            for (size_t j = 0; j < _zone.enemyTypes.size(); ++j)
             {
-                float weightRoll = m_floatDist(m_rng);
-                float cumulative = 0.0f;
-                for (size_t j = 0; j < zone.enemyTypes.size(); ++j)
+                cumulative += (j < _zone.enemyWeights.size()) ? _zone.enemyWeights[j] : 0.5f;
+                if (weightRoll <= cumulative)
                 {
-                    cumulative += (j < zone.enemyWeights.size()) ? zone.enemyWeights[j] : 0.5f;
-                    if (weightRoll <= cumulative)
-                    {
-                        if (zone.enemyTypes[j] == "mushroom")
-                            enemyVariant = EnemyVariant::Mushroom;
-                        break;
-                    }
+                    if (_zone.enemyTypes[j] == "mushroom")
+                        enemyVariant = EnemyVariant::Mushroom;
+                    break;
                 }
             }
-            
-            float leftBound = zone.x + _chunk.worldOffsetX;
-            float rightBound = zone.x + zone.width + _chunk.worldOffsetX - enemyWidth;
-            
-            Entity* enemy = EntityFactory::CreateEnemy(worldX, worldY, enemyVariant, leftBound, rightBound);
-            m_entityManager->GetAllEntities().push_back(enemy);
-            _chunk.entities.push_back(enemy);
         }
+        
+        float leftBound = _zone.x + _chunk.worldOffsetX;
+        float rightBound = _zone.x + _zone.width + _chunk.worldOffsetX - enemyWidth;
+        
+        _chunk.entities.push_back(EntityFactory::CreateEnemy(commands, worldX, worldY, enemyVariant, leftBound, rightBound));
     }
 }
 
+void ChunkMap::QueueSpawnEntities(uint32_t _serial)
+{
+    // One spawn zone per step; stops early if the chunk is gone (despawned or reset).
+    // The zone's entities are created within the step, not at the next tick's sync
+    // point, so the spawning itself is what the queue's budget limits.
+    m_tasks->Submit([this, _serial, zone = size_t(0)]() mutable
+    {
+        ChunkInstance* chunk = FindChunk(_serial);
+        if (!chunk || !chunk->tileMap || !m_entityManager) return true;
+        
+        const auto& coinZones = chunk->tileMap->GetCoinSpawnZones();
+        const auto& enemyZones = chunk->tileMap->GetEnemySpawnZones();
+        if (zone < coinZones.size()) SpawnCoinZone(*chunk, coinZones[zone]);
+        else if (zone - coinZones.size() < enemyZones.size()) SpawnEnemyZone(*chunk, enemyZones[zone - coinZones.size()]);
+        m_entityManager->ApplyCommands();
+        
+        return ++zone >= coinZones.size() + enemyZones.size();
+    });
+}
+
+void ChunkMap::QueueCleanupEntities(vector<EntityID> _entities)
+{
+    // A few destroys per step, applied within it like spawns; the buffer goes back
+    // to the spares once empty
+    m_tasks->Submit([this, entities = std::move(_entities), next = size_t(0)]() mutable
+    {
+        const size_t destroysPerStep = 16;
+        size_t end = std::min(entities.size(), next + destroysPerStep);
+        if (m_entityManager)
+        {
+            for (; next < end; ++next)
+                m_entityManager->DestroyEntity(entities[next]);
+            m_entityManager->ApplyCommands();
+        }
+        next = end;
+        if (next < entities.size()) return false;
+        
+        entities.clear();
+        m_spareEntityLists.push_back(std::move(entities));
+        return true;
+    });
+}
+
+ChunkInstance* ChunkMap::FindChunk(uint32_t _serial)
+{
+    for (auto& chunk : m_activeChunks)
+        if (chunk.serial == _serial) return &chunk;
+    return nullptr;
+}
+
 void ChunkMap::CleanupChunkEntities(ChunkInstance& _chunk)
 {
     if (!m_entityManager) return;
     
-    for (auto* entity : _chunk.entities)
-    {
-        if (entity)
-            m_entityManager->DestroyEntity(entity);
-    }
+    for (EntityID entity : _chunk.entities)
+        m_entityManager->DestroyEntity(entity);
     _chunk.entities.clear();
 }
 
-void ChunkMap::Render(Renderer* _renderer, Camera* _camera)
+void ChunkMap::ExtractVisibleChunks(float _cameraX, float _screenWidth, vector<ChunkDraw>& _out) const
 {
-    float cameraX = _camera ? _camera->GetX() : 0.0f;
-    Point logicalSize = _renderer->GetLogicalSize();
-    int screenWidth = logicalSize.X;
-    
     for (const auto& chunk : m_activeChunks)
     {
         float chunkRight = chunk.worldOffsetX + m_chunkWidth;
-        if (chunkRight < cameraX || chunk.worldOffsetX > cameraX + screenWidth)
+        if (chunkRight < _cameraX || chunk.worldOffsetX > _cameraX + _screenWidth)
             continue;
         
-        RenderChunkWithOffset(_renderer, _camera, chunk);
+        _out.push_back({ chunk.tileMap, chunk.worldOffsetX });
     }
 }
 
-void ChunkMap::RenderChunkWithOffset(Renderer* _renderer, Camera* _camera, const ChunkInstance& _chunk)
+void ChunkMap::Render(Renderer* _renderer, float _cameraX, const vector<ChunkDraw>& _chunks)
+{
+    for (const auto& chunk : _chunks)
+        RenderChunkWithOffset(_renderer, _cameraX, chunk);
+}
+
+void ChunkMap::RenderChunkWithOffset(Renderer* _renderer, float _cameraX, const ChunkDraw& _chunk)
 {
     if (!_chunk.tileMap) return;
     
     SDL_Renderer* sdl = _renderer->GetRenderer();
-    float cameraX = _camera ? _camera->GetX() : 0.0f;
+    float cameraX = _cameraX;
     
     TileMap* tileMap = _chunk.tileMap;
     float offsetX = _chunk.worldOffsetX;
@@ -539,6 +612,15 @@ void ChunkMap::Reset()
 
 int ChunkMap::GetChunkPixelWidth() const { return m_chunkWidth; }
 
+void ChunkMap::GetActivityRegion(float _cameraX, float _screenWidth, float& _left, float& _right) const
+{
+    float width = (float)m_chunkWidth;
+    if (width <= 0) { _left = _cameraX; _right = _cameraX + _screenWidth; return; }
+
+    _left = floor((_cameraX - width * 0.5f) / width) * width;
+    _right = (floor((_cameraX + _screenWidth + width * 0.5f) / width) + 1) * width;
+}
+
 int ChunkMap::GetMapPixelHeight() const
 {
     return m_startChunk ? m_startChunk->GetMapPixelHeight() : 0;
@@ -4,11 +4,13 @@
 #include "../Core/StandardIncludes.h"
 #include "../Graphics/TileMap.h"
 #include "../Graphics/Camera.h"
+#include "Entity.h"
+#include "RenderSnapshot.h"
 #include <random>
 
 class Renderer;
-class Entity;
 class EntityManager;
+class TimeSlicedQueue;
 
 struct BackgroundLayer
 {
@@ -23,7 +25,8 @@ struct ChunkInstance
     TileMap* tileMap = nullptr;
     float worldOffsetX = 0.0f;
     int chunkType = 0;
-    vector<Entity*> entities;
+    uint32_t serial = 0;          // Unique per spawned chunk, for work that finds it later
+    vector<EntityID> entities;    // Handles, may go stale if destroyed elsewhere
 };
 
 class ChunkMap
@@ -34,6 +37,10 @@ public:
 
     void SetEntityManager(EntityManager* manager) { m_entityManager = manager; }
 
+    // Populate and clear chunks a few entities per step through _tasks instead of
+    // all at once; without a queue it happens immediately
+    void SetTaskQueue(TimeSlicedQueue* _tasks) { m_tasks = _tasks; }
+
     bool Load(const string& _startChunkPath);
     void LoadDefaultChunks();
     void AddRandomChunk(const string& _path);
@@ -41,10 +48,14 @@ public:
     void AddFloatingChunk(const string& _path);
     
     void AddBackgroundLayer(const string& _path, float _parallaxFactor);
-    void RenderBackgrounds(Renderer* _renderer, Camera* _camera);
+    // _farthestOnly skips the nearer parallax layers (frame budget)
+    void RenderBackgrounds(Renderer* _renderer, float _cameraX, bool _farthestOnly = false);
     
     void Update(float _cameraX, float _screenWidth);
-    void Render(Renderer* _renderer, Camera* _camera);
+
+    // Append the chunks visible from _cameraX to _out, for drawing later with Render
+    void ExtractVisibleChunks(float _cameraX, float _screenWidth, vector<ChunkDraw>& _out) const;
+    void Render(Renderer* _renderer, float _cameraX, const vector<ChunkDraw>& _chunks);
     
     bool CheckCollisionTop(float _x, float _y, float _width, float _height, float& _outGroundY) const;
     bool CheckCollisionBottom(float _x, float _y, float _width, float _height, float& _outCeilingY) const;
@@ -55,6 +66,11 @@ public:
     void Reset();
     
     int GetChunkPixelWidth() const;
+
+    // World x range whose entities should stay awake: the chunks within half a chunk
+    // of the view, so entities are woken before they scroll into sight and stay
+    // awake until the scroll system has recycled them behind the camera
+    void GetActivityRegion(float _cameraX, float _screenWidth, float& _left, float& _right) const;
     int GetMapPixelHeight() const;
     
     // Debug rendering for collision shapes
@@ -64,11 +80,18 @@ private:
     void SpawnNextChunk();
     int SelectRandomChunkType();
     TileMap* SelectRandomChunkVariant(int _type);
-    void RenderChunkWithOffset(Renderer* _renderer, Camera* _camera, const ChunkInstance& _chunk);
+    void RenderChunkWithOffset(Renderer* _renderer, float _cameraX, const ChunkDraw& _chunk);
     void SpawnEntitiesForChunk(ChunkInstance& _chunk);
+    void SpawnCoinZone(ChunkInstance& _chunk, const CoinSpawnZone& _zone);
+    void SpawnEnemyZone(ChunkInstance& _chunk, const EnemySpawnZone& _zone);
+    void QueueSpawnEntities(uint32_t _serial);
+    void QueueCleanupEntities(vector<EntityID> _entities);
     void CleanupChunkEntities(ChunkInstance& _chunk);
+    ChunkInstance* FindChunk(uint32_t _serial);
     
     EntityManager* m_entityManager;
+    TimeSlicedQueue* m_tasks;
+    uint32_t m_nextSerial;
     
     TileMap* m_startChunk;
     vector<TileMap*> m_randomChunks;
@@ -76,6 +99,7 @@ private:
     vector<TileMap*> m_floatingChunks;
     
     vector<ChunkInstance> m_activeChunks;
+    vector<vector<EntityID>> m_spareEntityLists;    // Recycled ChunkInstance::entities buffers
     vector<BackgroundLayer> m_backgroundLayers;
 
     float m_nextChunkX;
@@ -0,0 +1,182 @@
+#include "ColliderCache.h"
+#include "Archetype.h"
+#include <SDL_cpuinfo.h>
+#include <cmath>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define COLLIDER_KERNELS_X86 1
+#include <immintrin.h>
+
+// MSVC emits AVX intrinsics anywhere; GCC and Clang need the function marked
+#if defined(_MSC_VER)
+#define AVX_FUNCTION
+#else
+#define AVX_FUNCTION __attribute__((target("avx")))
+#endif
+#endif
+
+constexpr uint32_t ColliderBoxes::BATCH;
+constexpr uint32_t ColliderCache::NONE;
+
+// Min edges past any max edge and the other way round
+const ColliderBox ColliderBoxes::EMPTY_BOX = { INFINITY, INFINITY, -INFINITY, -INFINITY };
+
+static uint32_t OverlapMaskScalar(const float* _minX, const float* _minY, const float* _maxX, const float* _maxY, const ColliderBox& _box)
+{
+    uint32_t mask = 0;
+    for (uint32_t k = 0; k < ColliderBoxes::BATCH; ++k)
+    {
+        bool hit = _box.minX < _maxX[k] && _box.maxX > _minX[k] &&
+                   _box.minY < _maxY[k] && _box.maxY > _minY[k];
+        mask |= (uint32_t)hit << k;
+    }
+    return mask;
+}
+
+#ifdef COLLIDER_KERNELS_X86
+static uint32_t OverlapMaskSSE(const float* _minX, const float* _minY, const float* _maxX, const float* _maxY, const ColliderBox& _box)
+{
+    __m128 boxMinX = _mm_set1_ps(_box.minX);
+    __m128 boxMinY = _mm_set1_ps(_box.minY);
+    __m128 boxMaxX = _mm_set1_ps(_box.maxX);
+    __m128 boxMaxY = _mm_set1_ps(_box.maxY);
+
+    uint32_t mask = 0;
+    for (uint32_t k = 0; k < ColliderBoxes::BATCH; k += 4)
+    {
+        __m128 hit = _mm_and_ps(
+            _mm_and_ps(_mm_cmplt_ps(boxMinX, _mm_loadu_ps(_maxX + k)), _mm_cmpgt_ps(boxMaxX, _mm_loadu_ps(_minX + k))),
+            _mm_and_ps(_mm_cmplt_ps(boxMinY, _mm_loadu_ps(_maxY + k)), _mm_cmpgt_ps(boxMaxY, _mm_loadu_ps(_minY + k))));
+        mask |= (uint32_t)_mm_movemask_ps(hit) << k;
+    }
+    return mask;
+}
+
+AVX_FUNCTION static uint32_t OverlapMaskAVX(const float* _minX, const float* _minY, const float* _maxX, const float* _maxY, const ColliderBox& _box)
+{
+    __m256 hitX = _mm256_and_ps(
+        _mm256_cmp_ps(_mm256_set1_ps(_box.minX), _mm256_loadu_ps(_maxX), _CMP_LT_OQ),
+        _mm256_cmp_ps(_mm256_set1_ps(_box.maxX), _mm256_loadu_ps(_minX), _CMP_GT_OQ));
+    __m256 hitY = _mm256_and_ps(
+        _mm256_cmp_ps(_mm256_set1_ps(_box.minY), _mm256_loadu_ps(_maxY), _CMP_LT_OQ),
+        _mm256_cmp_ps(_mm256_set1_ps(_box.maxY), _mm256_loadu_ps(_minY), _CMP_GT_OQ));
+    return (uint32_t)_mm256_movemask_ps(_mm256_and_ps(hitX, hitY));
+}
+#endif
+
+ColliderBoxes::KernelFunc ColliderBoxes::s_kernelFunc = OverlapMaskScalar;
+OverlapKernel ColliderBoxes::s_kernel = OverlapKernel::Scalar;
+
+// Pick the widest kernel before anything runs a query
+static struct OverlapKernelSelector
+{
+    OverlapKernelSelector() { ColliderBoxes::SetKernel(OverlapKernel::AVX); }
+} s_overlapKernelSelector;
+
+OverlapKernel ColliderBoxes::DetectKernel()
+{
+#ifdef COLLIDER_KERNELS_X86
+    if (SDL_HasAVX()) return OverlapKernel::AVX;
+    if (SDL_HasSSE2()) return OverlapKernel::SSE;
+#endif
+    return OverlapKernel::Scalar;
+}
+
+void ColliderBoxes::SetKernel(OverlapKernel _kernel)
+{
+    OverlapKernel supported = DetectKernel();
+    s_kernel = _kernel > supported ? supported : _kernel;
+
+    switch (s_kernel)
+    {
+#ifdef COLLIDER_KERNELS_X86
+    case OverlapKernel::AVX: s_kernelFunc = OverlapMaskAVX; break;
+    case OverlapKernel::SSE: s_kernelFunc = OverlapMaskSSE; break;
+#endif
+    default: s_kernelFunc = OverlapMaskScalar; break;
+    }
+}
+
+void ColliderBoxes::Resize(uint32_t _count)
+{
+    m_count = _count;
+    m_minX.resize(_count + BATCH);
+    m_minY.resize(_count + BATCH);
+    m_maxX.resize(_count + BATCH);
+    m_maxY.resize(_count + BATCH);
+
+    for (uint32_t i = _count; i < _count + BATCH; ++i)
+        Set(i, EMPTY_BOX);
+}
+
+void ColliderBoxes::Set(uint32_t _index, const ColliderBox& _box)
+{
+    m_minX[_index] = _box.minX;
+    m_minY[_index] = _box.minY;
+    m_maxX[_index] = _box.maxX;
+    m_maxY[_index] = _box.maxY;
+}
+
+ColliderBox ColliderBoxes::Get(uint32_t _index) const
+{
+    return { m_minX[_index], m_minY[_index], m_maxX[_index], m_maxY[_index] };
+}
+
+void ColliderCache::Refresh(const std::vector<Archetype*>& _archetypes)
+{
+    // Dormant rows sit past the active count; some active rows may have been deactivated this tick
+    uint32_t count = 0;
+    for (Archetype* archetype : _archetypes)
+        for (uint32_t row = 0; row < archetype->GetActiveCount(); ++row)
+            if (archetype->GetEntity(row)->IsActive()) ++count;
+
+    m_entities.resize(count);
+    m_boxes.Resize(count);
+
+    uint32_t slot = 0;
+    for (Archetype* archetype : _archetypes)
+    {
+        auto* transforms = archetype->GetColumn<TransformComponent>();
+        auto* collisions = archetype->GetColumn<CollisionComponent>();
+
+        for (uint32_t row = 0; row < archetype->GetActiveCount(); ++row)
+        {
+            Entity* entity = archetype->GetEntity(row);
+            if (!entity->IsActive()) continue;
+
+            if (transforms && collisions)
+            {
+                const TransformComponent* transform = transforms->Get(row);
+                const CollisionComponent* collision = collisions->Get(row);
+                float x = transform->worldX + collision->offsetX;
+                float y = transform->worldY + collision->offsetY;
+                m_boxes.Set(slot, { x, y, x + collision->boxWidth, y + collision->boxHeight });
+            }
+            else
+            {
+                m_boxes.Set(slot, ColliderBoxes::EMPTY_BOX);
+            }
+
+            uint32_t index = GetEntityIndex(entity->GetID());
+            if (index >= m_slotOf.size()) m_slotOf.resize(index + 1, NONE);
+            m_slotOf[index] = slot;
+            m_entities[slot++] = entity;
+        }
+    }
+}
+
+void ColliderCache::Clear()
+{
+    m_boxes.Clear();
+    m_entities.clear();
+    m_slotOf.clear();
+}
+
+uint32_t ColliderCache::Find(Entity* _entity) const
+{
+    uint32_t index = GetEntityIndex(_entity->GetID());
+    if (index >= m_slotOf.size()) return NONE;
+
+    uint32_t slot = m_slotOf[index];
+    return slot < m_entities.size() && m_entities[slot] == _entity ? slot : NONE;
+}
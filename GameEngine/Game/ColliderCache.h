@@ -0,0 +1,108 @@
+#ifndef COLLIDER_CACHE_H
+#define COLLIDER_CACHE_H
+
+#include "Entity.h"
+#include "Components.h"
+#include <vector>
+
+class Archetype;
+
+// Collision box by its edges, in world space
+struct ColliderBox
+{
+    float minX, minY, maxX, maxY;
+};
+
+// Overlap kernel implementations, widest last
+enum class OverlapKernel : uint8_t { Scalar, SSE, AVX };
+
+/**
+ * Collider boxes as four float arrays (minX, minY, maxX, maxY).
+ *
+ * OverlapMask() tests one box against BATCH consecutive boxes and returns a
+ * bit per hit: AVX compares all eight in one instruction per edge, SSE four,
+ * the scalar kernel one at a time. The kernel is picked at startup from what
+ * the CPU supports. The arrays are padded with BATCH empty boxes, so a batch
+ * starting at any index up to the count can be loaded whole.
+ *
+ * Boxes overlap like SpatialGrid::AABBOverlap: touching edges do not count.
+ */
+class ColliderBoxes
+{
+public:
+    static constexpr uint32_t BATCH = 8;
+    static const ColliderBox EMPTY_BOX;     // Overlaps nothing, not even itself
+
+    // Change the number of boxes; boxes past the old count must be Set() before use
+    void Resize(uint32_t _count);
+    void Clear() { Resize(0); }
+    uint32_t GetCount() const { return m_count; }
+
+    void Set(uint32_t _index, const ColliderBox& _box);
+    ColliderBox Get(uint32_t _index) const;
+    const float* GetMinX() const { return m_minX.data(); }
+
+    // Bit k set when box _first + k overlaps _box, for k < BATCH; bits past the count stay clear
+    uint32_t OverlapMask(uint32_t _first, const ColliderBox& _box) const
+    {
+        return s_kernelFunc(&m_minX[_first], &m_minY[_first], &m_maxX[_first], &m_maxY[_first], _box);
+    }
+
+    // _func(index) for each box in [_begin, _end) that overlaps _box, in index order
+    template<typename Func>
+    void ForEachOverlap(const ColliderBox& _box, uint32_t _begin, uint32_t _end, Func&& _func) const
+    {
+        for (uint32_t first = _begin; first < _end; first += BATCH)
+        {
+            uint32_t mask = OverlapMask(first, _box);
+            if (_end - first < BATCH) mask &= (1u << (_end - first)) - 1;
+            for (uint32_t k = 0; mask != 0; ++k, mask >>= 1)
+                if (mask & 1) _func(first + k);
+        }
+    }
+
+    // Kernel all ColliderBoxes use. Set falls back to the widest one the CPU supports.
+    static void SetKernel(OverlapKernel _kernel);
+    static OverlapKernel GetKernel() { return s_kernel; }
+    static OverlapKernel DetectKernel();
+
+private:
+    using KernelFunc = uint32_t (*)(const float*, const float*, const float*, const float*, const ColliderBox&);
+
+    static KernelFunc s_kernelFunc;
+    static OverlapKernel s_kernel;
+
+    std::vector<float> m_minX, m_minY, m_maxX, m_maxY;
+    uint32_t m_count = 0;
+};
+
+/**
+ * Boxes of every active collider, re-read from the Transform and Collision
+ * columns of their archetypes once per frame, so broad-phase tests work on
+ * packed floats instead of fetching components per pair.
+ */
+class ColliderCache
+{
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    // Re-read the active entities of _archetypes (those with both components)
+    void Refresh(const std::vector<Archetype*>& _archetypes);
+
+    void Clear();
+
+    // Slot of _entity as of the last Refresh(), or NONE if it was not there
+    uint32_t Find(Entity* _entity) const;
+
+    uint32_t GetCount() const { return m_boxes.GetCount(); }
+    Entity* GetEntity(uint32_t _slot) const { return m_entities[_slot]; }
+    ColliderBox GetBox(uint32_t _slot) const { return m_boxes.Get(_slot); }
+    const ColliderBoxes& GetBoxes() const { return m_boxes; }
+
+private:
+    ColliderBoxes m_boxes;
+    std::vector<Entity*> m_entities;    // Per slot
+    std::vector<uint32_t> m_slotOf;     // Per entity index, checked against m_entities
+};
+
+#endif // COLLIDER_CACHE_H
@@ -0,0 +1,200 @@
+#ifndef COMPONENT_VIEW_H
+#define COMPONENT_VIEW_H
+
+#include "Archetype.h"
+#include "../Core/JobSystem.h"
+#include <algorithm>
+
+// Stamp rows [_begin, _end) of T's column changed, unless T is const (read-only)
+template<typename T>
+void MarkComponentWritten(Archetype* _archetype, uint32_t _begin, uint32_t _end, uint32_t _tick, std::false_type)
+{
+    if (_begin < _end) _archetype->GetColumn(ComponentTypeID<T>::value)->MarkChanged(_begin, _end, _tick);
+}
+
+template<typename T>
+void MarkComponentWritten(Archetype*, uint32_t, uint32_t, uint32_t, std::true_type) {}
+
+template<typename... Ts>
+void MarkComponentsWritten(Archetype* _archetype, uint32_t _begin, uint32_t _end, uint32_t _tick)
+{
+    int expand[] = { 0, (MarkComponentWritten<Ts>(_archetype, _begin, _end, _tick, std::is_const<Ts>()), 0)... };
+    (void)expand;
+}
+
+/**
+ * Typed view over every active entity that has all of Ts.
+ *
+ * Each() walks the active range of each matching archetype one column block
+ * at a time and calls the function with component references:
+ *
+ *   manager.Each<TransformComponent, MovementComponent>(
+ *       [&](TransformComponent& t, MovementComponent& m) { t.worldX += m.velocityX * dt; });
+ *
+ * Inactive entities sit past the active range, so the inner loop is a plain
+ * indexed loop over block pointers with no per-entity checks. The callback
+ * must not add/remove components or create/destroy entities; flipping
+ * SetActive is fine and takes effect after EntityManager's next sync point.
+ *
+ * EachWithEntity()/ParallelEachWithEntity() also pass the row's Entity* first,
+ * for callbacks that need its ID (e.g. to stagger work over ticks by index).
+ *
+ * ParallelEach() hands runs of _blocksPerJob blocks to the JobSystem and waits
+ * for them. Blocks never share a row, so the callback may write the components
+ * it receives without locking; anything else it touches must be thread-safe.
+ *
+ * Components a view hands out non-const are stamped changed at the storage's
+ * current tick; name a component const (View<TransformComponent, const MovementComponent>)
+ * when it is only read so change-driven consumers do not see it as written.
+ */
+template<typename... Ts>
+class ComponentView
+{
+public:
+    ComponentView(ArchetypeStorage& _storage)
+        : m_archetypes(&_storage.GetQuery(MakeSignature<Ts...>())), m_tick(_storage.GetTick())
+    {
+    }
+
+    template<typename Func>
+    void Each(Func&& _func) const
+    {
+        for (Archetype* archetype : *m_archetypes)
+            EachInRange(_func, archetype, 0, archetype->GetActiveCount(), m_tick);
+    }
+
+    template<typename Func>
+    void ParallelEach(const Func& _func, uint32_t _blocksPerJob = 4) const
+    {
+        ParallelRanges([&_func](Archetype* _archetype, uint32_t _begin, uint32_t _end, uint32_t _tick)
+        {
+            EachInRange(_func, _archetype, _begin, _end, _tick);
+        }, _blocksPerJob);
+    }
+
+    template<typename Func>
+    void EachWithEntity(Func&& _func) const
+    {
+        for (Archetype* archetype : *m_archetypes)
+            EachInRangeWithEntity(_func, archetype, 0, archetype->GetActiveCount(), m_tick);
+    }
+
+    template<typename Func>
+    void ParallelEachWithEntity(const Func& _func, uint32_t _blocksPerJob = 4) const
+    {
+        ParallelRanges([&_func](Archetype* _archetype, uint32_t _begin, uint32_t _end, uint32_t _tick)
+        {
+            EachInRangeWithEntity(_func, _archetype, _begin, _end, _tick);
+        }, _blocksPerJob);
+    }
+
+    // Call _func(entity, components...) for every entity, active or not, where
+    // any of Ts was added or written after _sinceTick. Nothing is marked changed.
+    template<typename Func>
+    void EachChanged(uint32_t _sinceTick, Func&& _func) const
+    {
+        for (Archetype* archetype : *m_archetypes)
+        {
+            for (uint32_t row = 0; row < archetype->GetCount(); ++row)
+            {
+                if (!ChangedSince(archetype, row, _sinceTick)) continue;
+                _func(archetype->GetEntity(row), *archetype->GetColumn<typename std::remove_const<Ts>::type>()->Get(row)...);
+            }
+        }
+    }
+
+    uint32_t CountActive() const
+    {
+        uint32_t count = 0;
+        for (Archetype* archetype : *m_archetypes)
+            count += archetype->GetActiveCount();
+        return count;
+    }
+
+private:
+    // _range(archetype, begin, end, tick) over every active row, in jobs of _blocksPerJob
+    // blocks, or inline when that would be a single job
+    template<typename RangeFunc>
+    void ParallelRanges(const RangeFunc& _range, uint32_t _blocksPerJob) const
+    {
+        JobSystem& jobs = JobSystem::Instance();
+        uint32_t rowsPerJob = _blocksPerJob * COMPONENT_BLOCK_SIZE;
+        if (jobs.IsSingleThreaded() || CountActive() <= rowsPerJob)
+        {
+            for (Archetype* archetype : *m_archetypes)
+                _range(archetype, 0, archetype->GetActiveCount(), m_tick);
+            return;
+        }
+
+        JobCounter counter;
+        uint32_t tick = m_tick;
+        for (Archetype* archetype : *m_archetypes)
+        {
+            uint32_t activeCount = archetype->GetActiveCount();
+            for (uint32_t start = 0; start < activeCount; start += rowsPerJob)
+            {
+                uint32_t end = std::min(activeCount, start + rowsPerJob);
+                jobs.Submit([&_range, archetype, start, end, tick]()
+                {
+                    _range(archetype, start, end, tick);
+                }, &counter);
+            }
+        }
+        jobs.Wait(&counter);
+    }
+
+    // Rows [_begin, _end) of one archetype; _begin is block-aligned
+    template<typename Func>
+    static void EachInRange(Func& _func, Archetype* _archetype, uint32_t _begin, uint32_t _end, uint32_t _tick)
+    {
+        // Every non-const component the view hands out counts as written
+        MarkComponentsWritten<Ts...>(_archetype, _begin, _end, _tick);
+
+        for (uint32_t row = _begin; row < _end; row += COMPONENT_BLOCK_SIZE)
+        {
+            uint32_t block = row / COMPONENT_BLOCK_SIZE;
+            uint32_t count = std::min(COMPONENT_BLOCK_SIZE, _end - row);
+            EachInBlock(_func, count, _archetype->GetColumn<typename std::remove_const<Ts>::type>()->GetBlock(block)...);
+        }
+    }
+
+    template<typename Func>
+    static void EachInBlock(Func& _func, uint32_t _count, Ts*... _blocks)
+    {
+        for (uint32_t i = 0; i < _count; ++i)
+            _func(_blocks[i]...);
+    }
+
+    template<typename Func>
+    static void EachInRangeWithEntity(Func& _func, Archetype* _archetype, uint32_t _begin, uint32_t _end, uint32_t _tick)
+    {
+        MarkComponentsWritten<Ts...>(_archetype, _begin, _end, _tick);
+
+        for (uint32_t row = _begin; row < _end; row += COMPONENT_BLOCK_SIZE)
+        {
+            uint32_t block = row / COMPONENT_BLOCK_SIZE;
+            uint32_t count = std::min(COMPONENT_BLOCK_SIZE, _end - row);
+            EachInBlockWithEntity(_func, _archetype, row, count, _archetype->GetColumn<typename std::remove_const<Ts>::type>()->GetBlock(block)...);
+        }
+    }
+
+    template<typename Func>
+    static void EachInBlockWithEntity(Func& _func, Archetype* _archetype, uint32_t _firstRow, uint32_t _count, Ts*... _blocks)
+    {
+        for (uint32_t i = 0; i < _count; ++i)
+            _func(_archetype->GetEntity(_firstRow + i), _blocks[i]...);
+    }
+
+    static bool ChangedSince(Archetype* _archetype, uint32_t _row, uint32_t _tick)
+    {
+        bool changed = false;
+        int expand[] = { 0, (changed = changed || _archetype->GetColumn(ComponentTypeID<Ts>::value)->GetChangeTick(_row) > _tick, 0)... };
+        (void)expand;
+        return changed;
+    }
+
+    const std::vector<Archetype*>* m_archetypes;
+    uint32_t m_tick;
+};
+
+#endif // COMPONENT_VIEW_H
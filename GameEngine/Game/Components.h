@@ -2,7 +2,8 @@
 #define COMPONENTS_H
 
 #include "Entity.h"
-#include "../Graphics/AnimatedSpriteLoader.h"
+#include "TimerWheel.h"
+#include "../Graphics/AnimationSet.h"
 #include <functional>
 
 // World position, size, and scale
@@ -13,18 +14,32 @@ struct TransformComponent : Component
     float width = 16, height = 16;
     float scale = 1;
     int mapInstance = 0;            // Which map chunk instance this belongs to
+    float prevX = 0, prevY = 0;     // Position at the start of the last simulation tick
+    bool interpolate = false;       // Clear after teleporting so rendering does not smear
 };
 
-// Sprite rendering and animation
+// Where to draw a transform, _alpha of the way from the previous tick's position to the current one
+inline float InterpolatedX(const TransformComponent& _transform, float _alpha)
+{
+    return _transform.interpolate ? _transform.prevX + (_transform.worldX - _transform.prevX) * _alpha : _transform.worldX;
+}
+
+inline float InterpolatedY(const TransformComponent& _transform, float _alpha)
+{
+    return _transform.interpolate ? _transform.prevY + (_transform.worldY - _transform.prevY) * _alpha : _transform.worldY;
+}
+
+// Sprite rendering and animation playback cursor into a shared AnimationSet
 struct SpriteComponent : Component
 {
-    AnimatedSpriteLoader* animLoader = nullptr;
-    string currentAnimation = "idle";
+    const AnimationSet* animSet = nullptr;  // Shared, owned by AnimationLibrary
+    AnimClip clip = AnimClip::Idle;
+    float clipTime = 0;                     // Frames elapsed in the current clip
     bool facingRight = true;
     bool visible = true;
     bool flickering = false;
     int flickerCounter = 0;
-    ~SpriteComponent() override { delete animLoader; }
+    double lastUpdateTime = -1;             // SimLod::time of the last clip advance, < 0 before the first
 };
 
 // Movement velocity and speed settings
@@ -52,12 +67,14 @@ struct JumpComponent : Component
     float jumpForce = -300;
     float jumpHoldForce = -400;     // Extra force while holding jump
     float jumpMaxHoldTime = 0.5f;
-    float jumpHoldTimer = 0;
+    bool isHolding = false;         // Hold force still applies to this jump
+    TimerID holdEnd = INVALID_TIMER;
     float coyoteTime = 0.12f;       // Grace period after leaving ground
-    float coyoteTimer = 0;
+    bool canCoyoteJump = false;     // Grounded, or left the ground within coyoteTime
+    TimerID coyoteEnd = INVALID_TIMER;
 };
 
-enum class ColliderType { Player, Enemy, Coin, Obstacle };
+enum class ColliderType { Player, Enemy, Coin, Obstacle, Count };
 
 // Collision detection box
 struct CollisionComponent : Component
@@ -72,13 +89,13 @@ struct CollisionComponent : Component
 struct HealthComponent : Component
 {
     int health = 3, maxHealth = 3;
-    float invincibleTimer = 0;
     float invincibleDuration = 1.5f;
     bool isInvincible = false;
+    TimerID invincibleEnd = INVALID_TIMER;
     bool isDead = false;
     bool isFullyDead = false;       // After death animation completes
-    float deathTimer = 0;
     float deathDuration = 1;
+    TimerID deathEnd = INVALID_TIMER;
 };
 
 // AI patrol boundaries
@@ -86,6 +103,7 @@ struct PatrolComponent : Component
 {
     float leftBoundary = 0, rightBoundary = 0;
     float baseLeftBoundary = 0, baseRightBoundary = 0;  // Original bounds
+    double lastUpdateTime = -1;     // SimLod::time of the last patrol update, < 0 before the first
 };
 
 enum class CollectibleType { Coin1, Coin2, Diamond };
@@ -120,9 +138,10 @@ struct DashComponent : Component
     bool isDashing = false;
     float dashSpeed = 500;          // Speed during dash
     float dashDuration = 0.15f;     // How long dash lasts
-    float dashTimer = 0;
+    TimerID dashEnd = INVALID_TIMER;
     float dashCooldown = 0.5f;      // Time between dashes
-    float cooldownTimer = 0;
+    bool onCooldown = false;
+    TimerID cooldownEnd = INVALID_TIMER;
 };
 
 // Punch attack ability
@@ -131,7 +150,7 @@ struct PunchComponent : Component
     bool punchPressed = false;
     bool isPunching = false;
     float punchDuration = 0.3f;     // How long punch animation lasts
-    float punchTimer = 0;
+    TimerID punchEnd = INVALID_TIMER;
     float punchRange = 25;          // Hit enemies within 25 pixels
     bool hasHit = false;            // Prevent multiple hits per punch
 };
@@ -143,4 +162,28 @@ struct ScrollableComponent : Component
     std::function<void(Entity*)> onReposition;  // Callback when repositioned
 };
 
+// Every component type, in ID order. Append new components at the end.
+using AllComponents = ComponentList<
+    TransformComponent,
+    SpriteComponent,
+    MovementComponent,
+    PhysicsComponent,
+    JumpComponent,
+    CollisionComponent,
+    HealthComponent,
+    PatrolComponent,
+    CollectibleComponent,
+    EnemyComponent,
+    PlayerTag,
+    InputComponent,
+    DashComponent,
+    PunchComponent,
+    ScrollableComponent>;
+
+// Compile-time component ID: index of T in AllComponents
+template<typename T>
+struct ComponentTypeID : ComponentIndex<T, AllComponents> {};
+
+static_assert(ComponentTypeID<ScrollableComponent>::value < MAX_COMPONENTS, "Too many component types for ComponentSignature");
+
 #endif // COMPONENTS_H
@@ -1,11 +1,12 @@
 #include "Entity.h"
 
-// Static counter for generating unique entity IDs
-// Each new entity gets an incrementing ID (1, 2, 3, ...)
-EntityID Entity::s_nextID = 1;
+// Constructor: takes the handle issued by EntityManager, sets entity as active
+// and places it in the empty archetype
+Entity::Entity(ArchetypeStorage& _storage, EntityID _id)
+    : m_id(_id), m_isActive(true), m_isDormant(false), m_storage(&_storage), m_archetype(nullptr), m_row(0)
+{
+    m_storage->AddEntity(this);
+}
 
-// Constructor: assigns unique ID and sets entity as active
-Entity::Entity() : m_id(s_nextID++), m_isActive(true) {}
-
-// Destructor: clears all components (unique_ptr handles deletion)
-Entity::~Entity() { m_components.clear(); }
+// Destructor: destroys this entity's components in their archetype columns
+Entity::~Entity() { m_storage->RemoveEntity(this); }
@@ -2,72 +2,151 @@
 #define ENTITY_H
 
 #include "../Core/StandardIncludes.h"
-#include <unordered_map>
-#include <typeindex>
+#include "Archetype.h"
 #include <memory>
 
+// Generational handle: low bits index a slot in EntityManager, high bits hold the
+// slot's version. Destroying an entity bumps the version so old handles go stale.
 using EntityID = uint32_t;
 constexpr EntityID INVALID_ENTITY = 0;
+constexpr uint32_t ENTITY_INDEX_BITS = 20;
+constexpr uint32_t ENTITY_INDEX_MASK = (1u << ENTITY_INDEX_BITS) - 1;
+constexpr uint32_t ENTITY_VERSION_MASK = (1u << (32 - ENTITY_INDEX_BITS)) - 1;
+
+inline EntityID MakeEntityID(uint32_t _index, uint32_t _version) { return (_version << ENTITY_INDEX_BITS) | _index; }
+inline uint32_t GetEntityIndex(EntityID _id) { return _id & ENTITY_INDEX_MASK; }
+inline uint32_t GetEntityVersion(EntityID _id) { return _id >> ENTITY_INDEX_BITS; }
 
 struct Component
 {
-    virtual ~Component() = default;
 };
 
 /**
- * Entity is a container holds components.
- * 
+ * Entity is a handle to a row in its archetype's component columns.
+ *
  * Component-based architecture:
  * - Entity = unique ID + collection of components
  * - Components = data only (position, health, sprite, etc.)
  * - Systems = logic that operates on entities with specific components
+ *
+ * Components are stored in ArchetypeStorage, not in the entity. Adding or removing
+ * a component moves the entity to another archetype, so component pointers from
+ * this entity are only valid until its component set changes.
  */
 
 class Entity
 {
 public:
-    Entity();
+    Entity(ArchetypeStorage& _storage, EntityID _id);
     ~Entity();
 
     EntityID GetID() const { return m_id; }
     bool IsValid() const { return m_id != INVALID_ENTITY; }
-    void SetActive(bool active) { m_isActive = active; }
-    bool IsActive() const { return m_isActive; }
+    void SetActive(bool active) { m_storage->SetActive(this, active); }
+    // Dormant entities (outside the activity region) count as inactive until woken
+    bool IsActive() const { return m_isActive && !m_isDormant; }
+    void SetDormant(bool dormant) { m_storage->SetDormant(this, dormant); }
+    bool IsDormant() const { return m_isDormant; }
+
+    Archetype* GetArchetype() const { return m_archetype; }
+    uint32_t GetRow() const { return m_row; }
+
+    // Bitmask of the components this entity has
+    const ComponentSignature& GetSignature() const { return m_archetype->GetSignature(); }
 
     // Add a component of type T to this entity
     template<typename T, typename... Args>
     T* AddComponent(Args&&... args)
     {
-        auto comp = std::make_unique<T>(std::forward<Args>(args)...);
-        T* ptr = comp.get();
-        m_components[std::type_index(typeid(T))] = std::move(comp);
-        return ptr;
+        return m_storage->AddComponent<T>(this, std::forward<Args>(args)...);
     }
 
     // Get a component of type T, returns nullptr if not found
     template<typename T>
     T* GetComponent()
     {
-        auto it = m_components.find(std::type_index(typeid(T)));
-        return it != m_components.end() ? static_cast<T*>(it->second.get()) : nullptr;
+        TypedColumn<T>* column = m_archetype->GetColumn<T>();
+        return column ? column->Get(m_row) : nullptr;
+    }
+
+    // Stamp T as changed this tick; call after writing through GetComponent()
+    // so change-driven consumers (spatial grid, ...) pick the write up
+    template<typename T>
+    void MarkChanged()
+    {
+        if (TypedColumn<T>* column = m_archetype->GetColumn<T>())
+            column->MarkChanged(m_row, m_storage->GetTick());
     }
 
     // Check if entity has a component of type T
     template<typename T>
     bool HasComponent() const
     {
-        return m_components.find(std::type_index(typeid(T))) != m_components.end();
+        return m_archetype->Has(ComponentTypeID<T>::value);
     }
 
     // Remove a component of type T
     template<typename T>
-    void RemoveComponent() { m_components.erase(std::type_index(typeid(T))); }
+    void RemoveComponent() { m_storage->RemoveComponent<T>(this); }
 
 private:
+    friend class ArchetypeStorage;
+
     EntityID m_id;
     bool m_isActive;
-    std::unordered_map<std::type_index, std::unique_ptr<Component>> m_components;
-    static EntityID s_nextID;
+    bool m_isDormant;
+    ArchetypeStorage* m_storage;
+    Archetype* m_archetype;
+    uint32_t m_row;
 };
 
+template<typename T, typename... Args>
+T* ArchetypeStorage::AddComponent(Entity* _entity, Args&&... _args)
+{
+    Archetype* source = _entity->m_archetype;
+
+    // Already present: replace the value in place
+    if (TypedColumn<T>* existing = source->GetColumn<T>())
+    {
+        T* component = existing->Get(_entity->m_row);
+        *component = T(std::forward<Args>(_args)...);
+        existing->MarkChanged(_entity->m_row, m_tick);
+        return component;
+    }
+
+    ComponentID id = ComponentTypeID<T>::value;
+    Archetype* target = source->m_addEdges[id];
+    if (!target)
+    {
+        target = FindOrCreateWith(source, std::unique_ptr<ComponentColumn>(new TypedColumn<T>(GetBlockPool<T>())));
+        source->m_addEdges[id] = target;
+    }
+
+    MoveEntity(_entity, target);
+    TypedColumn<T>* column = target->GetColumn<T>();
+    T* component = column->Emplace(std::forward<Args>(_args)...);
+    column->MarkChanged(_entity->m_row, m_tick);
+    if (m_indexed.test(id)) m_indices[id].Insert(_entity);
+    return component;
+}
+
+template<typename T>
+void ArchetypeStorage::RemoveComponent(Entity* _entity)
+{
+    Archetype* source = _entity->m_archetype;
+    ComponentID id = ComponentTypeID<T>::value;
+    if (!source->Has(id)) return;
+
+    Archetype* target = source->m_removeEdges[id];
+    if (!target)
+    {
+        target = FindOrCreateWithout(source, id);
+        source->m_removeEdges[id] = target;
+    }
+
+    MoveEntity(_entity, target);
+    if (m_indexed.test(id)) m_indices[id].Remove(_entity);
+    ++m_membershipVersion;
+}
+
 #endif
@@ -0,0 +1,29 @@
+#include "EntityCommandBuffer.h"
+#include "EntityManager.h"
+
+EntityCommandBuffer::EntityCommandBuffer(EntityManager& _manager, std::atomic<uint64_t>& _sequence)
+    : m_manager(&_manager), m_sequence(&_sequence)
+{
+}
+
+EntityID EntityCommandBuffer::Create(std::function<void(Entity*)> _build)
+{
+    EntityID id = m_manager->ReserveEntity();
+    Record(CommandType::Create, id, std::move(_build));
+    return id;
+}
+
+void EntityCommandBuffer::Destroy(EntityID _id)
+{
+    if (_id != INVALID_ENTITY) Record(CommandType::Destroy, _id, nullptr);
+}
+
+void EntityCommandBuffer::Record(CommandType _type, EntityID _id, std::function<void(Entity*)> _apply)
+{
+    Command command;
+    command.sequence = m_sequence->fetch_add(1, std::memory_order_relaxed);
+    command.type = _type;
+    command.id = _id;
+    command.apply = std::move(_apply);
+    m_commands.push_back(std::move(command));
+}
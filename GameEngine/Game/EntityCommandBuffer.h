@@ -0,0 +1,70 @@
+#ifndef ENTITY_COMMAND_BUFFER_H
+#define ENTITY_COMMAND_BUFFER_H
+
+#include "Entity.h"
+#include <functional>
+#include <atomic>
+
+class EntityManager;
+
+/**
+ * Records structural changes (create, destroy, add/remove component) so they
+ * can be applied later at a sync point instead of while systems iterate.
+ *
+ * EntityManager owns one buffer per JobSystem thread; GetCommandBuffer() picks
+ * the calling thread's, so recording never takes a lock. Every command is
+ * stamped from one global sequence and playback merges the buffers in stamp
+ * order, so commands from systems the scheduler ordered apply in that order.
+ *
+ *   EntityID coin = manager.GetCommandBuffer().Create([](Entity* e) { ... });
+ *   manager.GetCommandBuffer().RemoveComponent<PatrolComponent>(enemy);
+ *
+ * The handle returned by Create() is valid immediately but only resolves
+ * through EntityManager::Get() after playback.
+ */
+class EntityCommandBuffer
+{
+public:
+    EntityCommandBuffer(EntityManager& _manager, std::atomic<uint64_t>& _sequence);
+
+    // Reserve a handle now; at playback the entity is created and passed to _build
+    EntityID Create(std::function<void(Entity*)> _build);
+
+    void Destroy(EntityID _id);
+
+    // Add (or overwrite) a component with a copy of _component
+    template<typename T>
+    void AddComponent(EntityID _id, const T& _component)
+    {
+        Record(CommandType::Modify, _id, [_component](Entity* _entity) { _entity->AddComponent<T>(_component); });
+    }
+
+    template<typename T>
+    void RemoveComponent(EntityID _id)
+    {
+        Record(CommandType::Modify, _id, [](Entity* _entity) { _entity->RemoveComponent<T>(); });
+    }
+
+    bool IsEmpty() const { return m_commands.empty(); }
+
+private:
+    friend class EntityManager;
+
+    enum class CommandType : uint8_t { Create, Destroy, Modify };
+
+    struct Command
+    {
+        uint64_t sequence;
+        CommandType type;
+        EntityID id;
+        std::function<void(Entity*)> apply;
+    };
+
+    void Record(CommandType _type, EntityID _id, std::function<void(Entity*)> _apply);
+
+    EntityManager* m_manager;
+    std::atomic<uint64_t>* m_sequence;
+    std::vector<Command> m_commands;
+};
+
+#endif // ENTITY_COMMAND_BUFFER_H
@@ -1,24 +1,19 @@
 #include "EntityManager.h"
 #include "ChunkMap.h"
-#include "../Audio/GameAudioManager.h"
-#include <algorithm>
 #include <random>
 
-Entity* EntityFactory::CreatePlayer(float x, float y)
+// m_sparse entry for a handle index with no live entity
+static const uint32_t INVALID_SLOT = 0xFFFFFFFF;
+
+Entity* EntityFactory::CreatePlayer(EntityManager& manager, float x, float y)
 {
-    Entity* entity = new Entity();
+    Entity* entity = manager.CreateEntity();
 
     auto* transform = entity->AddComponent<TransformComponent>();
     transform->worldX = transform->baseX = x;
     transform->worldY = transform->baseY = y;
 
-    auto* sprite = entity->AddComponent<SpriteComponent>();
-    sprite->animLoader = new AnimatedSpriteLoader();
-    sprite->animLoader->LoadAnimation("idle", "../Assets/Textures/Player/idle.png", 1, 4, 16, 16, 4, 8.0f);
-    sprite->animLoader->LoadAnimation("run", "../Assets/Textures/Player/run.png", 1, 4, 16, 16, 4, 12.0f);
-    sprite->animLoader->LoadAnimation("jumpandfall", "../Assets/Textures/Player/jumpandfall.png", 1, 2, 16, 16, 2, 8.0f);
-    sprite->animLoader->LoadAnimation("hurt", "../Assets/Textures/Player/hurt.png", 1, 2, 16, 16, 2, 2.0f);
-    sprite->animLoader->LoadAnimation("punch", "../Assets/Textures/Player/punch1.png", 1, 4, 16, 16, 4, 12.0f);
+    entity->AddComponent<SpriteComponent>()->animSet = AnimationLibrary::Instance().Get(AnimSetID::Player);
 
     entity->AddComponent<MovementComponent>();
     entity->AddComponent<PhysicsComponent>();
@@ -33,34 +28,36 @@ Entity* EntityFactory::CreatePlayer(float x, float y)
     return entity;
 }
 
-Entity* EntityFactory::CreateEnemy(float x, float y, EnemyVariant type, float left, float right)
+Entity* EntityFactory::CreateEnemy(EntityManager& manager, float x, float y, EnemyVariant type, float left, float right)
 {
-    Entity* entity = new Entity();
+    Entity* entity = manager.CreateEntity();
+    BuildEnemy(entity, x, y, type, left, right);
+    return entity;
+}
+
+EntityID EntityFactory::CreateEnemy(EntityCommandBuffer& commands, float x, float y, EnemyVariant type, float left, float right)
+{
+    return commands.Create([=](Entity* entity) { BuildEnemy(entity, x, y, type, left, right); });
+}
 
+void EntityFactory::BuildEnemy(Entity* entity, float x, float y, EnemyVariant type, float left, float right)
+{
     auto* transform = entity->AddComponent<TransformComponent>();
     transform->baseX = transform->worldX = x - 8;
     transform->baseY = transform->worldY = y - 16;
 
+    // Each AddComponent moves the entity to a new archetype, so configure
+    // a component before adding the next one
     auto* sprite = entity->AddComponent<SpriteComponent>();
-    sprite->animLoader = new AnimatedSpriteLoader();
+    sprite->animSet = AnimationLibrary::Instance().Get(type == EnemyVariant::Ghost ? AnimSetID::Ghost : AnimSetID::Mushroom);
 
     auto* movement = entity->AddComponent<MovementComponent>();
     movement->direction = (rand() % 2) ? -1.0f : 1.0f;
+    movement->moveSpeed = (type == EnemyVariant::Ghost) ? 30.0f : 40.0f;
 
     auto* enemy = entity->AddComponent<EnemyComponent>();
     enemy->variant = type;
 
-    if (type == EnemyVariant::Ghost)
-    {
-        sprite->animLoader->LoadAnimation("idle", "../Assets/Textures/Enemy/ghost1_fly.png", 1, 6, 16, 16, 6, 10.0f);
-        movement->moveSpeed = 30;
-    }
-    else
-    {
-        sprite->animLoader->LoadAnimation("idle", "../Assets/Textures/Enemy/mushroom-walk.png", 1, 10, 16, 16, 10, 10.0f);
-        movement->moveSpeed = 40;
-    }
-
     auto* patrol = entity->AddComponent<PatrolComponent>();
     patrol->baseLeftBoundary = left;
     patrol->baseRightBoundary = right;
@@ -74,114 +71,246 @@ Entity* EntityFactory::CreateEnemy(float x, float y, EnemyVariant type, float le
         auto* mov = ent->GetComponent<MovementComponent>();
         if (mov) mov->direction = (rand() % 2) ? -1.0f : 1.0f;
     };
+}
 
+Entity* EntityFactory::CreateCoin(EntityManager& manager, float x, float y, CollectibleType type)
+{
+    Entity* entity = manager.CreateEntity();
+    BuildCoin(entity, x, y, type);
     return entity;
 }
 
-Entity* EntityFactory::CreateCoin(float x, float y, CollectibleType type)
+EntityID EntityFactory::CreateCoin(EntityCommandBuffer& commands, float x, float y, CollectibleType type)
 {
-    Entity* entity = new Entity();
+    return commands.Create([=](Entity* entity) { BuildCoin(entity, x, y, type); });
+}
 
+void EntityFactory::BuildCoin(Entity* entity, float x, float y, CollectibleType type)
+{
     auto* transform = entity->AddComponent<TransformComponent>();
     transform->baseX = transform->worldX = x - 8;
     transform->baseY = transform->worldY = y - 16;
 
     auto* sprite = entity->AddComponent<SpriteComponent>();
-    sprite->animLoader = new AnimatedSpriteLoader();
+    if (type == CollectibleType::Coin1) sprite->animSet = AnimationLibrary::Instance().Get(AnimSetID::Coin1);
+    else if (type == CollectibleType::Coin2) sprite->animSet = AnimationLibrary::Instance().Get(AnimSetID::Coin2);
+    else sprite->animSet = AnimationLibrary::Instance().Get(AnimSetID::Diamond);
 
     auto* collectible = entity->AddComponent<CollectibleComponent>();
     collectible->type = type;
-
-    if (type == CollectibleType::Coin1)
-    {
-        sprite->animLoader->LoadAnimation("idle", "../Assets/Textures/Obstacles/coin1.png", 1, 10, 16, 16, 10, 10.0f);
-        collectible->pointValue = 10;
-    }
-    else if (type == CollectibleType::Coin2)
-    {
-        sprite->animLoader->LoadAnimation("idle", "../Assets/Textures/Obstacles/coin2.png", 1, 10, 16, 16, 10, 10.0f);
-        collectible->pointValue = 5;
-    }
-    else
-    {
-        sprite->animLoader->LoadAnimation("idle", "../Assets/Textures/Obstacles/diamond.png", 1, 5, 16, 16, 5, 10.0f);
-        collectible->pointValue = 15;
-    }
+    if (type == CollectibleType::Coin1) collectible->pointValue = 10;
+    else if (type == CollectibleType::Coin2) collectible->pointValue = 5;
+    else collectible->pointValue = 15;
 
     auto* collision = entity->AddComponent<CollisionComponent>();
     collision->type = ColliderType::Coin;
     collision->isTrigger = true;
 
     entity->AddComponent<ScrollableComponent>();
-
-    return entity;
 }
 
-Entity* EntityFactory::CreateRandomCoin(float x, float y)
+CollectibleType EntityFactory::RandomCoinType()
 {
     static std::mt19937 gen(std::random_device{}());
     static std::uniform_int_distribution<> dist(0, 2);
     CollectibleType types[] = { CollectibleType::Coin1, CollectibleType::Coin2, CollectibleType::Diamond };
-    return CreateCoin(x, y, types[dist(gen)]);
+    return types[dist(gen)];
 }
 
-Entity* EntityFactory::CreateRandomEnemy(float x, float y, float left, float right)
+Entity* EntityFactory::CreateRandomCoin(EntityManager& manager, float x, float y)
 {
-    return CreateEnemy(x, y, (rand() % 2) ? EnemyVariant::Ghost : EnemyVariant::Mushroom, left, right);
+    return CreateCoin(manager, x, y, RandomCoinType());
+}
+
+EntityID EntityFactory::CreateRandomCoin(EntityCommandBuffer& commands, float x, float y)
+{
+    return CreateCoin(commands, x, y, RandomCoinType());
+}
+
+Entity* EntityFactory::CreateRandomEnemy(EntityManager& manager, float x, float y, float left, float right)
+{
+    return CreateEnemy(manager, x, y, (rand() % 2) ? EnemyVariant::Ghost : EnemyVariant::Mushroom, left, right);
+}
+
+EntityManager::EntityManager()
+{
+    // Tags and singletons systems look up directly instead of searching for
+    m_storage.IndexComponents(MakeSignature<PlayerTag, InputComponent, EnemyComponent, CollectibleComponent>());
+
+    // Systems resolve their archetype queries once; the storage keeps them current
+    System* systems[] = { &m_input, &m_physics, &m_punch, &m_movement, &m_patrol, &m_collision,
+                          &m_scroll, &m_entityCollision, &m_animation, &m_render };
+    for (System* system : systems)
+        system->Initialize(m_storage);
+
+    // Logical update order; the scheduler only reorders systems that do not conflict
+    System* updateOrder[] = { &m_input, &m_physics, &m_punch, &m_movement, &m_patrol, &m_collision,
+                              &m_scroll, &m_entityCollision, &m_animation };
+    for (System* system : updateOrder)
+        m_scheduler.Add(system);
+    m_scheduler.Build();
+
+    m_commandBuffers.emplace_back(new EntityCommandBuffer(*this, m_commandSequence));
+
+    auto addScore = [this](const GameEventBatch& batch) { m_score += batch.totalValue; };
+    m_events.Subscribe(GameEventType::CoinCollected, addScore);
+    m_events.Subscribe(GameEventType::EnemyStomped, addScore);
+
+    RegisterTimerHandlers();
+}
+
+void EntityManager::RegisterTimerHandlers()
+{
+    m_timers.SetHandler(TimerKind::InvincibilityEnd, [this](EntityID id)
+    {
+        auto* health = GetComponent<HealthComponent>(id);
+        if (!health) return;
+        health->isInvincible = false;
+        health->invincibleEnd = INVALID_TIMER;
+    });
+    m_timers.SetHandler(TimerKind::DeathEnd, [this](EntityID id)
+    {
+        auto* health = GetComponent<HealthComponent>(id);
+        if (!health) return;
+        health->isFullyDead = true;
+        health->deathEnd = INVALID_TIMER;
+    });
+    m_timers.SetHandler(TimerKind::DashEnd, [this](EntityID id)
+    {
+        auto* dash = GetComponent<DashComponent>(id);
+        if (!dash) return;
+        dash->isDashing = false;
+        dash->dashEnd = INVALID_TIMER;
+        dash->onCooldown = true;
+        m_timers.Start(dash->cooldownEnd, id, TimerKind::DashCooldownEnd, dash->dashCooldown);
+        if (auto* movement = GetComponent<MovementComponent>(id)) movement->velocityX = 0;
+    });
+    m_timers.SetHandler(TimerKind::DashCooldownEnd, [this](EntityID id)
+    {
+        auto* dash = GetComponent<DashComponent>(id);
+        if (!dash) return;
+        dash->onCooldown = false;
+        dash->cooldownEnd = INVALID_TIMER;
+    });
+    m_timers.SetHandler(TimerKind::PunchEnd, [this](EntityID id)
+    {
+        auto* punch = GetComponent<PunchComponent>(id);
+        if (!punch) return;
+        punch->isPunching = false;
+        punch->punchEnd = INVALID_TIMER;
+    });
+    m_timers.SetHandler(TimerKind::JumpHoldEnd, [this](EntityID id)
+    {
+        auto* jump = GetComponent<JumpComponent>(id);
+        if (!jump) return;
+        jump->isHolding = false;
+        jump->holdEnd = INVALID_TIMER;
+    });
+    m_timers.SetHandler(TimerKind::CoyoteEnd, [this](EntityID id)
+    {
+        auto* jump = GetComponent<JumpComponent>(id);
+        if (!jump) return;
+        jump->canCoyoteJump = false;
+        jump->coyoteEnd = INVALID_TIMER;
+    });
 }
 
 EntityManager::~EntityManager() { Clear(); }
 
 Entity* EntityManager::CreateEntity()
 {
-    Entity* entity = new Entity();
+    return Spawn(ReserveEntity());
+}
+
+EntityID EntityManager::ReserveEntity()
+{
+    std::lock_guard<std::mutex> lock(m_handleMutex);
+    if (!m_freeIndices.empty())
+    {
+        uint32_t index = m_freeIndices.back();
+        m_freeIndices.pop_back();
+        return MakeEntityID(index, m_versions[index]);
+    }
+
+    // Brand-new indices start at version 1; the arrays grow when the entity is spawned
+    return MakeEntityID(m_nextIndex++, 1);
+}
+
+Entity* EntityManager::Spawn(EntityID id)
+{
+    uint32_t index = GetEntityIndex(id);
+    if (index >= m_versions.size())
+    {
+        m_versions.resize(index + 1, 1);
+        m_sparse.resize(index + 1, INVALID_SLOT);
+    }
+
+    Entity* entity = m_entityPool.Create(m_storage, id);
+    m_sparse[index] = static_cast<uint32_t>(m_entities.size());
     m_entities.push_back(entity);
     return entity;
 }
 
 void EntityManager::DestroyEntity(Entity* entity)
 {
-    if (entity) m_pendingDestroy.push_back(entity);
+    if (entity) GetCommandBuffer().Destroy(entity->GetID());
+}
+
+void EntityManager::DestroyEntity(EntityID id)
+{
+    GetCommandBuffer().Destroy(id);
+}
+
+EntityCommandBuffer& EntityManager::GetCommandBuffer()
+{
+    return *m_commandBuffers[JobSystem::GetThreadIndex()];
+}
+
+Entity* EntityManager::Get(EntityID id) const
+{
+    uint32_t index = GetEntityIndex(id);
+    if (index >= m_versions.size() || m_versions[index] != GetEntityVersion(id)) return nullptr;
+
+    // Reserved handles have no entity until their Create command is played back
+    uint32_t slot = m_sparse[index];
+    return slot != INVALID_SLOT ? m_entities[slot] : nullptr;
 }
 
 Entity* EntityManager::GetPlayer()
 {
-    for (auto* entity : m_entities)
-        if (entity && entity->HasComponent<PlayerTag>()) return entity;
-    return nullptr;
+    return m_storage.GetSingleton<PlayerTag>();
 }
 
 void EntityManager::SetChunkMap(ChunkMap* map)
 {
     m_collision.SetChunkMap(map);
-    if (map) m_patrol.SetMapWidth(map->GetChunkPixelWidth());
+    if (map) m_patrol.GetStep<PatrolStep>().SetMapWidth(map->GetChunkPixelWidth());
 }
 
 void EntityManager::SetScrollParams(float camX, int screenW, int mapW)
 {
     m_scroll.SetParams(camX, screenW, mapW);
-    m_patrol.SetMapWidth(mapW);
+    m_lod.viewLeft = camX;
+    m_lod.viewRight = camX + screenW;
+    m_lod.enabled = screenW > 0;
+    m_patrol.GetStep<PatrolStep>().SetMapWidth(mapW);
 }
 
 void EntityManager::Update(float deltaTime)
 {
     if (deltaTime > 0.033f) deltaTime = 0.033f;
+    m_lod.tick = m_storage.GetTick();
+    m_lod.time += deltaTime;
 
-    m_input.Update(m_entities, deltaTime);
-    m_physics.Update(m_entities, deltaTime);
-    m_jump.Update(m_entities, deltaTime);
-    m_dash.Update(m_entities, deltaTime);
-    m_punch.Update(m_entities, deltaTime);
-    m_movement.Update(m_entities, deltaTime);
-    m_collision.Update(m_entities, deltaTime);
-    m_patrol.Update(m_entities, deltaTime);
-    m_scroll.Update(m_entities, deltaTime);
-    m_health.Update(m_entities, deltaTime);
-    
-    // Rebuild spatial grid after all movement is done
-    m_entityCollision.RebuildGrid(m_entities);
-    m_entityCollision.Update(m_entities, deltaTime);
-    m_animation.Update(m_entities, deltaTime);
+    // Sync point: apply changes recorded since the last frame, refresh active ranges
+    Sync();
+    if (m_activityRegion.Apply(*this)) m_storage.PartitionAll();
+    SnapshotTransforms();
+
+    // Expire timers first so systems see the states they end
+    m_timers.Advance(deltaTime);
+
+    m_scheduler.Run(*this, deltaTime);
 
     // Fall death
     if (Entity* player = GetPlayer())
@@ -192,18 +321,21 @@ void EntityManager::Update(float deltaTime)
         {
             health->isDead = true;
             health->health = 0;
-            health->deathTimer = 0;
-            
-            GameAudioManager::Instance().PlayDieSound();
+            m_timers.Start(health->deathEnd, player->GetID(), TimerKind::DeathEnd, health->deathDuration);
+            m_events.Emit(GameEventType::PlayerDied, player->GetID());
         }
     }
 
-    ProcessDestroys();
+    m_events.Dispatch();
+
+    // Writes from here until the next frame's systems belong to the next tick
+    m_storage.AdvanceTick();
+    Sync();
 }
 
-void EntityManager::Render(Renderer* renderer, Camera* camera)
+void EntityManager::ExtractSprites(float cameraX, float viewWidth, float alpha, vector<SpriteInstance>& out)
 {
-    m_render.Render(m_entities, renderer, camera);
+    m_render.Extract(cameraX, viewWidth, alpha, out);
 }
 
 void EntityManager::RenderSpatialGridDebug(Renderer* renderer, Camera* camera, float viewportWidth, float viewportHeight)
@@ -248,22 +380,106 @@ void EntityManager::RenderCollisionBoxDebug(Renderer* renderer, Camera* camera)
     }
 }
 
-void EntityManager::ProcessDestroys()
+void EntityManager::Sync()
 {
-    for (auto* entity : m_pendingDestroy)
+    // Workers may have been added since the last sync; give each thread its buffer
+    unsigned int threads = JobSystem::Instance().GetThreadCount();
+    while (m_commandBuffers.size() < threads)
+        m_commandBuffers.emplace_back(new EntityCommandBuffer(*this, m_commandSequence));
+
+    PlaybackCommands();
+    m_storage.PartitionAll();
+}
+
+void EntityManager::SnapshotTransforms()
+{
+    // Straight through the columns: this is bookkeeping, not a change consumers should see
+    for (Archetype* archetype : m_storage.GetQuery(MakeSignature<TransformComponent>()))
     {
-        auto it = std::find(m_entities.begin(), m_entities.end(), entity);
-        if (it != m_entities.end())
+        auto* transforms = archetype->GetColumn<TransformComponent>();
+        for (uint32_t i = 0; i < archetype->GetCount(); ++i)
         {
-            delete *it;
-            m_entities.erase(it);
+            auto* transform = transforms->Get(i);
+            transform->prevX = transform->worldX;
+            transform->prevY = transform->worldY;
+            transform->interpolate = true;
         }
     }
-    m_pendingDestroy.clear();
+}
+
+void EntityManager::PlaybackCommands()
+{
+    // Merge the per-thread buffers by sequence so recording order is preserved
+    std::vector<size_t> next(m_commandBuffers.size(), 0);
+    while (true)
+    {
+        EntityCommandBuffer::Command* command = nullptr;
+        size_t from = 0;
+        for (size_t i = 0; i < m_commandBuffers.size(); ++i)
+        {
+            auto& commands = m_commandBuffers[i]->m_commands;
+            if (next[i] < commands.size() && (!command || commands[next[i]].sequence < command->sequence))
+            {
+                command = &commands[next[i]];
+                from = i;
+            }
+        }
+        if (!command) break;
+        ++next[from];
+
+        // Stale handles (already destroyed, e.g. queued twice) resolve to nullptr
+        switch (command->type)
+        {
+        case EntityCommandBuffer::CommandType::Create:
+        {
+            Entity* entity = Spawn(command->id);
+            if (command->apply) command->apply(entity);
+            break;
+        }
+        case EntityCommandBuffer::CommandType::Destroy:
+            if (Entity* entity = Get(command->id)) RemoveEntity(entity);
+            break;
+        case EntityCommandBuffer::CommandType::Modify:
+            if (Entity* entity = Get(command->id)) command->apply(entity);
+            break;
+        }
+    }
+
+    for (auto& buffer : m_commandBuffers)
+        buffer->m_commands.clear();
+}
+
+void EntityManager::RemoveEntity(Entity* entity)
+{
+    // The collision grid keeps static colliders across frames by pointer
+    m_entityCollision.OnEntityRemoved(entity);
+
+    uint32_t index = GetEntityIndex(entity->GetID());
+
+    // Swap-and-pop the dense slot, patching the moved entity's sparse entry
+    uint32_t slot = m_sparse[index];
+    Entity* last = m_entities.back();
+    m_entities[slot] = last;
+    m_sparse[GetEntityIndex(last->GetID())] = slot;
+    m_entities.pop_back();
+
+    // Retire the handle; version 0 is skipped so no live ID equals INVALID_ENTITY
+    uint32_t version = (m_versions[index] + 1) & ENTITY_VERSION_MASK;
+    m_versions[index] = version ? version : 1;
+    m_sparse[index] = INVALID_SLOT;
+    {
+        std::lock_guard<std::mutex> lock(m_handleMutex);
+        m_freeIndices.push_back(index);
+    }
+
+    m_entityPool.Destroy(entity);
 }
 
 void EntityManager::Reset()
 {
+    // Entities are about to move back to where they started, not where they fell asleep
+    m_activityRegion.Clear(*this);
+
     for (auto* entity : m_entities)
     {
         if (!entity) continue;
@@ -279,6 +495,8 @@ void EntityManager::Reset()
             transform->worldX = transform->baseX;
             transform->worldY = transform->baseY;
             transform->mapInstance = 0;
+            transform->interpolate = false;
+            entity->MarkChanged<TransformComponent>();
         }
         if (movement)
         {
@@ -290,23 +508,29 @@ void EntityManager::Reset()
         {
             jump->isJumping = false;
             jump->jumpPressed = false;
-            jump->jumpHoldTimer = 0;
-            jump->coyoteTimer = 0;
+            jump->isHolding = false;
+            jump->canCoyoteJump = false;
+            m_timers.Cancel(jump->holdEnd);
+            m_timers.Cancel(jump->coyoteEnd);
         }
+        auto* patrol = entity->GetComponent<PatrolComponent>();
+        if (patrol) patrol->lastUpdateTime = -1;
+        if (sprite) sprite->lastUpdateTime = -1;
         auto* dash = entity->GetComponent<DashComponent>();
         if (dash)
         {
             dash->isDashing = false;
             dash->dashPressed = false;
-            dash->dashTimer = 0;
-            dash->cooldownTimer = 0;
+            dash->onCooldown = false;
+            m_timers.Cancel(dash->dashEnd);
+            m_timers.Cancel(dash->cooldownEnd);
         }
         auto* punch = entity->GetComponent<PunchComponent>();
         if (punch)
         {
             punch->isPunching = false;
             punch->punchPressed = false;
-            punch->punchTimer = 0;
+            m_timers.Cancel(punch->punchEnd);
             punch->hasHit = false;
         }
         if (health)
@@ -315,8 +539,8 @@ void EntityManager::Reset()
             health->isDead = false;
             health->isFullyDead = false;
             health->isInvincible = false;
-            health->deathTimer = 0;
-            health->invincibleTimer = 0;
+            m_timers.Cancel(health->deathEnd);
+            m_timers.Cancel(health->invincibleEnd);
         }
         if (sprite)
         {
@@ -324,13 +548,18 @@ void EntityManager::Reset()
             sprite->flickering = false;
             sprite->flickerCounter = 0;
         }
+        // Back on the board, and refiled in the grid's static layer by the transform change
+        if (auto* collectible = entity->GetComponent<CollectibleComponent>()) collectible->collected = false;
         entity->SetActive(true);
     }
 }
 
 void EntityManager::Clear()
 {
-    for (auto* entity : m_entities) delete entity;
-    m_entities.clear();
-    m_pendingDestroy.clear();
+    // Pending creates still own reserved handles, so play everything back first
+    PlaybackCommands();
+    m_activityRegion.Clear(*this);
+    while (!m_entities.empty()) RemoveEntity(m_entities.back());
+    m_events.Clear();
+    m_timers.Clear();
 }
@@ -4,58 +4,173 @@
 #include "Entity.h"
 #include "Components.h"
 #include "Systems.h"
+#include "FusedPass.h"
+#include "ComponentView.h"
+#include "SystemScheduler.h"
+#include "EntityCommandBuffer.h"
+#include "EventBus.h"
+#include "ActivityRegion.h"
+#include "TimerWheel.h"
+#include "../Utils/PoolAllocator.h"
 #include <vector>
+#include <mutex>
 
 class Renderer;
 class Camera;
 class ChunkMap;
+class EntityManager;
 
 /**
  * Factory for creating pre-configured entities.
- * Each method creates an entity with the appropriate components.
+ * Each method creates an entity in the given manager with the appropriate components.
+ * The EntityCommandBuffer overloads record the creation instead and return the
+ * reserved handle; the entity exists after the next playback.
  */
 class EntityFactory
 {
 public:
-    static Entity* CreatePlayer(float x, float y);
-    static Entity* CreateEnemy(float x, float y, EnemyVariant type, float left, float right);
-    static Entity* CreateCoin(float x, float y, CollectibleType type);
-    static Entity* CreateRandomCoin(float x, float y);
-    static Entity* CreateRandomEnemy(float x, float y, float left, float right);
+    static Entity* CreatePlayer(EntityManager& manager, float x, float y);
+    static Entity* CreateEnemy(EntityManager& manager, float x, float y, EnemyVariant type, float left, float right);
+    static Entity* CreateCoin(EntityManager& manager, float x, float y, CollectibleType type);
+    static Entity* CreateRandomCoin(EntityManager& manager, float x, float y);
+    static Entity* CreateRandomEnemy(EntityManager& manager, float x, float y, float left, float right);
+
+    static EntityID CreateEnemy(EntityCommandBuffer& commands, float x, float y, EnemyVariant type, float left, float right);
+    static EntityID CreateCoin(EntityCommandBuffer& commands, float x, float y, CollectibleType type);
+    static EntityID CreateRandomCoin(EntityCommandBuffer& commands, float x, float y);
+
+private:
+    static void BuildEnemy(Entity* entity, float x, float y, EnemyVariant type, float left, float right);
+    static void BuildCoin(Entity* entity, float x, float y, CollectibleType type);
+    static CollectibleType RandomCoinType();
 };
 
 /**
  * Manages all entities and systems.
  * 
  * Responsibilities:
- * - Create and destroy entities
+ * - Create and destroy entities, issuing generational EntityID handles
+ * - Apply recorded structural changes (EntityCommandBuffer) at sync points
+ * - Dispatch the frame's gameplay events (EventBus) once systems are done
+ * - Fire gameplay timers (TimerWheel) before systems run
+ * - Own the archetype storage holding all component data
  * - Run all systems each frame in correct order
  * - Provide access to player entity
  */
 class EntityManager
 {
 public:
-    EntityManager() = default;
+    EntityManager();
     ~EntityManager();
 
+    // Create immediately; only outside Update(), systems record through GetCommandBuffer()
     Entity* CreateEntity();
+
+    // Deferred: recorded in the calling thread's command buffer
     void DestroyEntity(Entity* entity);
+    void DestroyEntity(EntityID id);
+
+    // Command buffer of the calling JobSystem thread, played back at the next sync point
+    EntityCommandBuffer& GetCommandBuffer();
+
+    // Sync point on demand: play back every buffer now. Only outside Update(), so
+    // budgeted work (chunk population) pays for its own structural changes.
+    void ApplyCommands() { Sync(); }
+
+    // Hand out a handle for an entity created later (thread-safe)
+    EntityID ReserveEntity();
     Entity* GetPlayer();
     std::vector<Entity*>& GetAllEntities() { return m_entities; }
 
+    // Resolve a handle, nullptr if the entity has been destroyed
+    Entity* Get(EntityID id) const;
+    bool IsAlive(EntityID id) const { return Get(id) != nullptr; }
+
+    // Component of a live entity, nullptr if destroyed or missing
+    template<typename T>
+    T* GetComponent(EntityID id) const
+    {
+        Entity* entity = Get(id);
+        return entity ? entity->GetComponent<T>() : nullptr;
+    }
+    ArchetypeStorage& GetStorage() { return m_storage; }
+
+    // Typed iteration over active entities that have all of Ts (see ComponentView)
+    template<typename... Ts>
+    ComponentView<Ts...> View() { return ComponentView<Ts...>(m_storage); }
+
+    template<typename... Ts, typename Func>
+    void Each(Func&& func) { View<Ts...>().Each(std::forward<Func>(func)); }
+
+    // Each() split across the JobSystem; func must only touch the components it is given
+    template<typename... Ts, typename Func>
+    void ParallelEach(Func&& func) { View<Ts...>().ParallelEach(func); }
+
+    // ParallelEach() with the Entity* passed before the components
+    template<typename... Ts, typename Func>
+    void ParallelEachWithEntity(Func&& func) { View<Ts...>().ParallelEachWithEntity(func); }
+
     void SetChunkMap(ChunkMap* map);
     void SetScrollParams(float cameraX, int screenWidth, int mapWidth);
 
-    // Run all systems in order
+    // Entities outside world x [left, right] go dormant at the next Update; cellWidth
+    // is the granularity they are woken at (ChunkMap::GetActivityRegion)
+    void SetActivityRegion(float left, float right, float cellWidth)
+    {
+        m_activityRegion.Set(left, right, cellWidth);
+        m_entityCollision.SetGridWindow(left, right);
+    }
+    uint32_t GetDormantCount() const { return m_activityRegion.GetDormantCount(); }
+
+    // Update rates by distance from the view, from SetScrollParams
+    const SimLod& GetSimLod() const { return m_lod; }
+
+    // Off: the animation system skips entities outside the view (frame budget)
+    void SetOffscreenAnimation(bool enabled) { m_animation.SetCullOffscreen(!enabled); }
+
+    // Run all systems once (one simulation tick); conflicting systems keep this
+    // order, others may run in parallel
     void Update(float deltaTime);
-    void Render(Renderer* renderer, Camera* camera);
 
-    int GetScore() const { return m_entityCollision.GetScore(); }
-    void ResetScore() { m_entityCollision.ResetScore(); }
+    // Copy the sprites visible from cameraX into out (see RenderSnapshot), placed alpha (0..1)
+    // of the way from the previous tick's positions to the current ones
+    void ExtractSprites(float cameraX, float viewWidth, float alpha, vector<SpriteInstance>& out);
+
+    // Gameplay events raised by systems, dispatched at the end of Update()
+    EventBus& GetEvents() { return m_events; }
+
+    // Gameplay timers, advanced at the start of Update(); expiries are handled in
+    // RegisterTimerHandlers()
+    TimerWheel& GetTimers() { return m_timers; }
+
+    // Run timers without a simulation tick (the death animation after the game stops)
+    void AdvanceTimers(float deltaTime) { m_timers.Advance(deltaTime); }
+    void AdvanceAnimation(float deltaTime) { m_lod.time += deltaTime; m_animation.AdvanceClips(*this, deltaTime); }
+
+    // Points from CoinCollected/EnemyStomped events since the last reset
+    int GetScore() const { return m_score; }
+    void ResetScore() { m_score = 0; }
     
     // Debug visualization for spatial grid
     void ToggleSpatialGridDebug() { m_entityCollision.ToggleDebugDraw(); }
     bool IsSpatialGridDebugEnabled() const { return m_entityCollision.IsDebugDrawEnabled(); }
+
+    // Collision grid implementation (F4), and milliseconds its last update took
+    void SetGridBackend(GridBackend backend) { m_entityCollision.SetGridBackend(backend); }
+    GridBackend GetGridBackend() const { return m_entityCollision.GetGridBackend(); }
+    float GetGridUpdateTime() const { return m_entityCollision.GetLastGridTime(); }
+
+    // Active colliders overlapping a world region, as of the last update
+    void GetCollidersInRegion(float x, float y, float width, float height, vector<Entity*>& out)
+    {
+        m_entityCollision.GetCollidersInRegion(x, y, width, height, out);
+    }
+
+    // What happens when two moving colliders of the given types touch (none by default)
+    void SetPairHandler(ColliderType a, ColliderType b, EntityCollisionSystem::PairHandler handler)
+    {
+        m_entityCollision.SetPairHandler(a, b, std::move(handler));
+    }
     void RenderSpatialGridDebug(Renderer* renderer, Camera* camera, float viewportWidth, float viewportHeight);
     
     // Debug visualization for collision boxes (F2)
@@ -67,25 +182,51 @@ public:
     void Clear();
 
 private:
+    ArchetypeStorage m_storage;
+    PoolAllocator<Entity> m_entityPool;
+
+    // Sparse set: m_entities is dense, m_sparse maps a handle index to its dense slot
     std::vector<Entity*> m_entities;
-    std::vector<Entity*> m_pendingDestroy;
+    std::vector<uint32_t> m_sparse;
+    std::vector<uint32_t> m_versions;       // Current version per handle index
+    std::vector<uint32_t> m_freeIndices;
+    uint32_t m_nextIndex = 0;               // First handle index never handed out
+    std::mutex m_handleMutex;               // Guards m_freeIndices and m_nextIndex
+
+    std::vector<std::unique_ptr<EntityCommandBuffer>> m_commandBuffers;   // One per JobSystem thread
+    std::atomic<uint64_t> m_commandSequence{ 0 };
+
+    EventBus m_events;
+    TimerWheel m_timers;
+    ActivityRegion m_activityRegion;
+    SimLod m_lod;
+    int m_score = 0;
 
     // Systems are executed in this order each frame
     InputSystem m_input;
-    PhysicsSystem m_physics;
-    JumpSystem m_jump;
-    DashSystem m_dash;
+    PhysicsPass m_physics;      // Physics, jump, dash
     PunchSystem m_punch;
-    MovementSystem m_movement;
+    MovementPass m_movement;
+    PatrolPass m_patrol;        // Alongside m_collision, see PatrolStep
     CollisionSystem m_collision;
-    PatrolSystem m_patrol;
     ScrollSystem m_scroll;
-    HealthSystem m_health;
     EntityCollisionSystem m_entityCollision;
     AnimationSystem m_animation;
     RenderSystem m_render;
 
-    void ProcessDestroys();
+    SystemScheduler m_scheduler;
+
+    // Play back all command buffers and repartition active ranges
+    void Sync();
+    void PlaybackCommands();
+
+    // What each TimerKind ends when it fires
+    void RegisterTimerHandlers();
+
+    // Remember every transform's position as the start of this tick for interpolation
+    void SnapshotTransforms();
+    Entity* Spawn(EntityID id);
+    void RemoveEntity(Entity* entity);
     
     bool m_collisionBoxDebugEnabled = false;
 };
@@ -0,0 +1,65 @@
+#include "EventBus.h"
+
+constexpr uint32_t EventBus::CAPACITY;
+
+EventBus::EventBus()
+    : m_count(0), m_dropped(0)
+{
+}
+
+void EventBus::Emit(GameEventType _type, EntityID _entity, int _value)
+{
+    uint32_t slot = m_count.fetch_add(1, std::memory_order_relaxed);
+    if (slot >= CAPACITY) return;
+
+    GameEvent& event = m_events[slot];
+    event.type = _type;
+    event.entity = _entity;
+    event.value = _value;
+}
+
+void EventBus::Subscribe(GameEventType _type, std::function<void(const GameEventBatch&)> _handler)
+{
+    m_handlers[static_cast<size_t>(_type)].push_back(std::move(_handler));
+}
+
+void EventBus::Dispatch()
+{
+    uint32_t raised = m_count.load();
+    uint32_t count = std::min(raised, CAPACITY);
+    m_dropped += raised - count;
+    if (count == 0) return;
+
+    // Counting sort by type keeps each type's events in raise order
+    std::array<uint32_t, TYPE_COUNT + 1> offsets = {};
+    for (uint32_t i = 0; i < count; ++i)
+        ++offsets[static_cast<size_t>(m_events[i].type) + 1];
+    for (size_t type = 0; type < TYPE_COUNT; ++type)
+        offsets[type + 1] += offsets[type];
+
+    std::array<uint32_t, TYPE_COUNT> next;
+    std::copy(offsets.begin(), offsets.end() - 1, next.begin());
+    for (uint32_t i = 0; i < count; ++i)
+        m_sorted[next[static_cast<size_t>(m_events[i].type)]++] = m_events[i];
+
+    // Clear first so handlers may raise events for the next frame
+    m_count = 0;
+
+    for (size_t type = 0; type < TYPE_COUNT; ++type)
+    {
+        uint32_t begin = offsets[type];
+        uint32_t end = offsets[type + 1];
+        if (begin == end || m_handlers[type].empty()) continue;
+
+        GameEventBatch batch;
+        batch.type = static_cast<GameEventType>(type);
+        batch.events = &m_sorted[begin];
+        batch.count = end - begin;
+        batch.totalValue = 0;
+        for (uint32_t i = begin; i < end; ++i)
+            batch.totalValue += m_sorted[i].value;
+
+        for (auto& handler : m_handlers[type])
+            handler(batch);
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include "Entity.h"
+#include <array>
+#include <atomic>
+#include <functional>
+
+// Gameplay events raised by systems
+enum class GameEventType : uint8_t
+{
+    PlayerJumped,
+    PlayerDashed,
+    PlayerPunched,
+    CoinCollected,      // value = points
+    EnemyStomped,       // value = points
+    PlayerHurt,
+    PlayerDied,
+    Count
+};
+
+struct GameEvent
+{
+    GameEventType type;
+    EntityID entity;    // Entity the event is about
+    int value;
+};
+
+// Every event of one type raised this frame, in raise order
+struct GameEventBatch
+{
+    GameEventType type;
+    const GameEvent* events;
+    uint32_t count;
+    int totalValue;
+};
+
+/**
+ * Per-frame queue of gameplay events.
+ *
+ * Systems Emit() instead of calling audio, score or UI code directly, so
+ * they stay plain data transforms that can run on any thread. Emit() is
+ * lock-free and writes into a fixed array, nothing is allocated per event.
+ *
+ * EntityManager calls Dispatch() once per tick, after the systems have
+ * finished, on whichever thread runs the simulation. When frames are
+ * pipelined that is a JobSystem worker, so handlers must be safe to call
+ * off the main thread; anything that must stay on it (audio, SDL) records
+ * the event and acts on it later (see GameController::PlayQueuedSounds).
+ * Each handler gets one call per type with all of that type's events, so ten
+ * coins collected in one tick are one dispatch (and one sound), not ten.
+ */
+class EventBus
+{
+public:
+    static constexpr uint32_t CAPACITY = 256;   // Events per frame, extras are dropped
+
+    EventBus();
+
+    // Thread-safe
+    void Emit(GameEventType _type, EntityID _entity = INVALID_ENTITY, int _value = 0);
+
+    // Handlers are registered at startup and called from Dispatch(), on the simulation's thread
+    void Subscribe(GameEventType _type, std::function<void(const GameEventBatch&)> _handler);
+
+    // Hand this frame's events to the handlers grouped by type, then clear the queue
+    void Dispatch();
+
+    // Drop queued events without dispatching them
+    void Clear() { m_count = 0; }
+
+    // Events lost to a full queue since startup
+    uint32_t GetDroppedCount() const { return m_dropped; }
+
+private:
+    static constexpr size_t TYPE_COUNT = static_cast<size_t>(GameEventType::Count);
+
+    std::array<GameEvent, CAPACITY> m_events;
+    std::array<GameEvent, CAPACITY> m_sorted;   // m_events grouped by type during Dispatch
+    std::atomic<uint32_t> m_count;
+    uint32_t m_dropped;
+    std::array<std::vector<std::function<void(const GameEventBatch&)>>, TYPE_COUNT> m_handlers;
+};
+
+#endif // EVENT_BUS_H
@@ -0,0 +1,276 @@
+#include "FlatSpatialGrid.h"
+#include "../Graphics/Renderer.h"
+#include "../Graphics/Camera.h"
+#include "../Core/JobSystem.h"
+#include <algorithm>
+#include <climits>
+
+constexpr uint32_t FlatSpatialGrid::SLICE_SIZE;
+constexpr uint32_t FlatSpatialGrid::MAX_SLICES;
+constexpr int FlatSpatialGrid::MAX_COLUMNS;
+constexpr int FlatSpatialGrid::MAX_ROWS;
+
+FlatSpatialGrid::FlatSpatialGrid(int _cellSize)
+    : m_cellSize(_cellSize)
+{
+}
+
+void FlatSpatialGrid::SetWindow(float _left, float _right)
+{
+    m_windowLeft = _left;
+    m_windowRight = _right;
+}
+
+void FlatSpatialGrid::Clear()
+{
+    m_entities.clear();
+    m_ranges.clear();
+    m_items.clear();
+    m_cellStart.clear();
+    m_columns = m_rows = 0;
+}
+
+FlatSpatialGrid::CellRange FlatSpatialGrid::GetCellRange(Entity* _entity) const
+{
+    CellRange range = {};
+    if (!_entity || !_entity->IsActive()) return range;
+
+    auto* transform = _entity->GetComponent<TransformComponent>();
+    auto* collision = _entity->GetComponent<CollisionComponent>();
+    if (!transform || !collision) return range;
+
+    float x = transform->worldX + collision->offsetX;
+    float y = transform->worldY + collision->offsetY;
+
+    range.minX = static_cast<int>(floor(x / m_cellSize));
+    range.maxX = static_cast<int>(floor((x + collision->boxWidth) / m_cellSize));
+    range.minY = static_cast<int>(floor(y / m_cellSize));
+    range.maxY = static_cast<int>(floor((y + collision->boxHeight) / m_cellSize));
+    range.valid = true;
+    return range;
+}
+
+FlatSpatialGrid::CellRange FlatSpatialGrid::ToGrid(const CellRange& _cells) const
+{
+    CellRange range;
+    range.minX = std::min(std::max(_cells.minX - m_originX, 0), m_columns - 1);
+    range.maxX = std::min(std::max(_cells.maxX - m_originX, 0), m_columns - 1);
+    range.minY = std::min(std::max(_cells.minY - m_originY, 0), m_rows - 1);
+    range.maxY = std::min(std::max(_cells.maxY - m_originY, 0), m_rows - 1);
+    range.valid = _cells.valid;
+    return range;
+}
+
+void FlatSpatialGrid::Rebuild(const std::vector<Entity*>& _entities)
+{
+    JobSystem& jobs = JobSystem::Instance();
+    m_entities.assign(_entities.begin(), _entities.end());
+    uint32_t count = (uint32_t)m_entities.size();
+
+    // Component lookups and cell math are independent per entity
+    m_ranges.resize(count);
+    jobs.ParallelFor(count, 256, [this](uint32_t _begin, uint32_t _end)
+    {
+        for (uint32_t i = _begin; i < _end; ++i)
+            m_ranges[i] = GetCellRange(m_entities[i]);
+    });
+
+    Layout();
+    uint32_t cells = GetCellCount();
+    if (cells == 0)
+    {
+        m_items.clear();
+        return;
+    }
+
+    m_sliceCount = std::max(1u, std::min(MAX_SLICES, count / SLICE_SIZE));
+    m_sliceSize = (count + m_sliceCount - 1) / m_sliceCount;
+    m_sliceCounts.assign(m_sliceCount * cells, 0);
+
+    // Pass 1: each slice counts its entities per cell
+    jobs.ParallelFor(m_sliceCount, 1, [this](uint32_t _begin, uint32_t _end)
+    {
+        for (uint32_t slice = _begin; slice < _end; ++slice) CountSlice(slice);
+    });
+
+    // Counts to offsets, cell by cell with the slices in order inside each cell
+    m_cellStart.resize(cells + 1);
+    uint32_t offset = 0;
+    for (uint32_t cell = 0; cell < cells; ++cell)
+    {
+        m_cellStart[cell] = offset;
+        for (uint32_t slice = 0; slice < m_sliceCount; ++slice)
+        {
+            uint32_t& cursor = m_sliceCounts[slice * cells + cell];
+            uint32_t sliceCount = cursor;
+            cursor = offset;
+            offset += sliceCount;
+        }
+    }
+    m_cellStart[cells] = offset;
+
+    // Pass 2: each slice writes its entities at its own cursors
+    m_items.resize(offset);
+    jobs.ParallelFor(m_sliceCount, 1, [this](uint32_t _begin, uint32_t _end)
+    {
+        for (uint32_t slice = _begin; slice < _end; ++slice) ScatterSlice(slice);
+    });
+}
+
+void FlatSpatialGrid::Layout()
+{
+    int minX = INT_MAX, maxX = INT_MIN, minY = INT_MAX, maxY = INT_MIN;
+    for (const CellRange& range : m_ranges)
+    {
+        if (!range.valid) continue;
+        minX = std::min(minX, range.minX);
+        maxX = std::max(maxX, range.maxX);
+        minY = std::min(minY, range.minY);
+        maxY = std::max(maxY, range.maxY);
+    }
+    if (minX > maxX)
+    {
+        m_columns = m_rows = 0;
+        return;
+    }
+    m_extent = { minX, minY, maxX, maxY, true };
+
+    if (m_windowRight > m_windowLeft)
+    {
+        minX = static_cast<int>(floor(m_windowLeft / m_cellSize));
+        maxX = static_cast<int>(floor(m_windowRight / m_cellSize));
+    }
+
+    // Anything past the limits lands in the edge cells
+    m_originX = minX;
+    m_originY = minY;
+    m_columns = std::min(maxX - minX + 1, MAX_COLUMNS);
+    m_rows = std::min(maxY - minY + 1, MAX_ROWS);
+}
+
+void FlatSpatialGrid::CountSlice(uint32_t _slice)
+{
+    uint32_t* counts = &m_sliceCounts[_slice * GetCellCount()];
+    uint32_t end = std::min((uint32_t)m_entities.size(), (_slice + 1) * m_sliceSize);
+
+    for (uint32_t i = _slice * m_sliceSize; i < end; ++i)
+    {
+        CellRange& range = m_ranges[i];
+        if (!range.valid) continue;
+        range = ToGrid(range);
+
+        for (int column = range.minX; column <= range.maxX; ++column)
+            for (int row = range.minY; row <= range.maxY; ++row)
+                ++counts[CellIndex(column, row)];
+    }
+}
+
+void FlatSpatialGrid::ScatterSlice(uint32_t _slice)
+{
+    uint32_t* cursors = &m_sliceCounts[_slice * GetCellCount()];
+    uint32_t end = std::min((uint32_t)m_entities.size(), (_slice + 1) * m_sliceSize);
+
+    for (uint32_t i = _slice * m_sliceSize; i < end; ++i)
+    {
+        const CellRange& range = m_ranges[i];
+        if (!range.valid) continue;
+
+        for (int column = range.minX; column <= range.maxX; ++column)
+            for (int row = range.minY; row <= range.maxY; ++row)
+                m_items[cursors[CellIndex(column, row)]++] = i;
+    }
+}
+
+bool FlatSpatialGrid::QueryRange(const CellRange& _cells, CellRange& _query) const
+{
+    if (GetCellCount() == 0) return false;
+
+    // Trim to where colliders are first, so only cells truncated by the limits gain extras
+    CellRange cells = _cells;
+    cells.minX = std::max(cells.minX, m_extent.minX);
+    cells.maxX = std::min(cells.maxX, m_extent.maxX);
+    cells.minY = std::max(cells.minY, m_extent.minY);
+    cells.maxY = std::min(cells.maxY, m_extent.maxY);
+    if (cells.minX > cells.maxX || cells.minY > cells.maxY) return false;
+
+    _query = ToGrid(cells);
+    return true;
+}
+
+FlatSpatialGrid::CellRange FlatSpatialGrid::GetRegionRange(float _x, float _y, float _width, float _height) const
+{
+    CellRange cells;
+    cells.minX = static_cast<int>(floor(_x / m_cellSize));
+    cells.maxX = static_cast<int>(floor((_x + _width) / m_cellSize));
+    cells.minY = static_cast<int>(floor(_y / m_cellSize));
+    cells.maxY = static_cast<int>(floor((_y + _height) / m_cellSize));
+    cells.valid = true;
+    return cells;
+}
+
+void FlatSpatialGrid::GetNearbyEntities(Entity* _entity, std::vector<Entity*>& _out) const
+{
+    _out.clear();
+    ForEachNearby(_entity, [&_out](Entity* _e) { _out.push_back(_e); });
+}
+
+void FlatSpatialGrid::GetEntitiesInRegion(float _x, float _y, float _width, float _height, std::vector<Entity*>& _out) const
+{
+    _out.clear();
+    ForEachInRegion(_x, _y, _width, _height, [&_out](Entity* _e) { _out.push_back(_e); });
+}
+
+std::vector<Entity*> FlatSpatialGrid::GetNearbyEntities(Entity* _entity) const
+{
+    std::vector<Entity*> nearby;
+    GetNearbyEntities(_entity, nearby);
+    return nearby;
+}
+
+std::vector<Entity*> FlatSpatialGrid::GetEntitiesInRegion(float _x, float _y, float _width, float _height) const
+{
+    std::vector<Entity*> result;
+    GetEntitiesInRegion(_x, _y, _width, _height, result);
+    return result;
+}
+
+void FlatSpatialGrid::RenderDebug(Renderer* _renderer, Camera* _camera, float _viewportWidth, float _viewportHeight) const
+{
+    if (!_renderer || !_camera) return;
+
+    float cameraX = _camera->GetX();
+    float cameraY = _camera->GetY();
+
+    int minCellX = static_cast<int>(floor(cameraX / m_cellSize)) - 1;
+    int maxCellX = static_cast<int>(floor((cameraX + _viewportWidth) / m_cellSize)) + 1;
+    int minCellY = static_cast<int>(floor(cameraY / m_cellSize)) - 1;
+    int maxCellY = static_cast<int>(floor((cameraY + _viewportHeight) / m_cellSize)) + 1;
+
+    for (int cx = minCellX; cx <= maxCellX; ++cx)
+    {
+        for (int cy = minCellY; cy <= maxCellY; ++cy)
+        {
+            // Cells outside the grid are drawn empty, even though edge cells hold what is clamped into them
+            int column = cx - m_originX;
+            int row = cy - m_originY;
+            bool inside = column >= 0 && column < m_columns && row >= 0 && row < m_rows;
+            int cell = inside ? CellIndex(column, row) : 0;
+            bool hasEntities = inside && m_cellStart[cell + 1] > m_cellStart[cell];
+
+            if (hasEntities)
+                _renderer->SetDrawColor(Color(0, 255, 0, 255));  // Green
+            else
+                _renderer->SetDrawColor(Color(255, 0, 0, 128));  // Red
+
+            float screenX = _camera->WorldToScreenX((float)(cx * m_cellSize));
+            float screenY = (float)(cy * m_cellSize);
+            Rect cellRect(
+                static_cast<unsigned int>(screenX),
+                static_cast<unsigned int>(screenY),
+                static_cast<unsigned int>(screenX + m_cellSize),
+                static_cast<unsigned int>(screenY + m_cellSize)
+            );
+            _renderer->RenderRectangle(cellRect);
+        }
+    }
+}
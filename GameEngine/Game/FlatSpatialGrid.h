@@ -0,0 +1,143 @@
+#ifndef FLAT_SPATIAL_GRID_H
+#define FLAT_SPATIAL_GRID_H
+
+#include "Entity.h"
+#include "Components.h"
+#include <vector>
+#include <algorithm>
+
+class Renderer;
+class Camera;
+
+/**
+ * Uniform grid in flat arrays, rebuilt from scratch every frame.
+ *
+ * Columns cover a window of world x (the awake chunks), rows the height the
+ * colliders span; boxes past the window are clamped into its edge columns.
+ * Rebuild() is a two-pass counting sort: count the entities per cell, turn
+ * the counts into offsets, then scatter entity indices into one contiguous
+ * buffer, so a cell's entities are m_items[m_cellStart[c], m_cellStart[c + 1]).
+ * Large rebuilds split the entities into slices that count and scatter on the
+ * JobSystem, each into its own run of every cell, so a cell still lists its
+ * entities in input order.
+ *
+ * Nothing is inserted or removed between rebuilds. Queries match SpatialGrid;
+ * EntityCollisionSystem can use either (GridBackend) to compare them.
+ */
+class FlatSpatialGrid
+{
+public:
+    FlatSpatialGrid(int _cellSize = 64);
+
+    // World x range to lay the columns over; with none, the colliders' extent is used
+    void SetWindow(float _left, float _right);
+
+    void Clear();
+
+    // Replace the contents with _entities (inactive ones and those without a box are skipped)
+    void Rebuild(const std::vector<Entity*>& _entities);
+
+    // Call _func(entity) for each active entity in the cells of _entity's box and the
+    // cells around it, once each, in cell then input order. Allocates nothing.
+    template<typename Func>
+    void ForEachNearby(Entity* _entity, Func&& _func) const
+    {
+        CellRange cells = GetCellRange(_entity);
+        if (!cells.valid) return;
+        --cells.minX; --cells.minY;
+        ++cells.maxX; ++cells.maxY;
+        ForEachInCells(cells, _entity, _func);
+    }
+
+    // Same for the cells overlapping a world region
+    template<typename Func>
+    void ForEachInRegion(float _x, float _y, float _width, float _height, Func&& _func) const
+    {
+        ForEachInCells(GetRegionRange(_x, _y, _width, _height), nullptr, _func);
+    }
+
+    // Queries into a caller-owned buffer: _out is cleared and refilled, keeping its capacity
+    void GetNearbyEntities(Entity* _entity, std::vector<Entity*>& _out) const;
+    void GetEntitiesInRegion(float _x, float _y, float _width, float _height, std::vector<Entity*>& _out) const;
+
+    // Active entities in the cells of _entity's box and the cells around it
+    std::vector<Entity*> GetNearbyEntities(Entity* _entity) const;
+
+    // Active entities in the cells overlapping a world region
+    std::vector<Entity*> GetEntitiesInRegion(float _x, float _y, float _width, float _height) const;
+
+    // Debug rendering - draws grid cells (red = empty, green = has entities)
+    void RenderDebug(Renderer* _renderer, Camera* _camera, float _viewportWidth, float _viewportHeight) const;
+
+    int GetCellSize() const { return m_cellSize; }
+    uint32_t GetCellCount() const { return (uint32_t)(m_columns * m_rows); }
+
+private:
+    static constexpr uint32_t SLICE_SIZE = 512;     // Entities per rebuild job, at least
+    static constexpr uint32_t MAX_SLICES = 8;
+    static constexpr int MAX_COLUMNS = 512;
+    static constexpr int MAX_ROWS = 64;
+
+    // Inclusive cell range; world cells from GetCellRange, grid cells once clamped
+    struct CellRange
+    {
+        int minX, minY, maxX, maxY;
+        bool valid;
+    };
+    CellRange GetCellRange(Entity* _entity) const;
+    CellRange GetRegionRange(float _x, float _y, float _width, float _height) const;
+    CellRange ToGrid(const CellRange& _cells) const;
+    int CellIndex(int _column, int _row) const { return _column * m_rows + _row; }
+
+    // Fit columns and rows to the window and the entities' world ranges
+    void Layout();
+    void CountSlice(uint32_t _slice);
+    void ScatterSlice(uint32_t _slice);
+
+    // _cells trimmed to the colliders' extent and clamped to the grid; false if nothing is left
+    bool QueryRange(const CellRange& _cells, CellRange& _query) const;
+
+    // Call _func for active entities in world cells _cells, each once
+    template<typename Func>
+    void ForEachInCells(const CellRange& _cells, Entity* _exclude, Func& _func) const
+    {
+        CellRange query;
+        if (!QueryRange(_cells, query)) return;
+
+        for (int column = query.minX; column <= query.maxX; ++column)
+        {
+            for (int row = query.minY; row <= query.maxY; ++row)
+            {
+                int cell = CellIndex(column, row);
+                for (uint32_t k = m_cellStart[cell]; k < m_cellStart[cell + 1]; ++k)
+                {
+                    uint32_t index = m_items[k];
+
+                    // An entity in several cells is reported from the first one the query reaches
+                    const CellRange& range = m_ranges[index];
+                    if (column != std::max(query.minX, range.minX) || row != std::max(query.minY, range.minY)) continue;
+
+                    Entity* entity = m_entities[index];
+                    if (entity != _exclude && entity->IsActive()) _func(entity);
+                }
+            }
+        }
+    }
+
+    int m_cellSize;
+    float m_windowLeft = 0;
+    float m_windowRight = 0;
+    CellRange m_extent = {};                // World cells the colliders cover
+    int m_originX = 0, m_originY = 0;       // World cell of column 0, row 0
+    int m_columns = 0, m_rows = 0;
+    uint32_t m_sliceCount = 0;
+    uint32_t m_sliceSize = 0;
+
+    std::vector<Entity*> m_entities;        // Rebuild input, m_items indexes it
+    std::vector<CellRange> m_ranges;        // Per entity, in grid cells after CountSlice
+    std::vector<uint32_t> m_sliceCounts;    // Slice-major per-cell counts, then write cursors
+    std::vector<uint32_t> m_cellStart;      // Cell count + 1 offsets into m_items
+    std::vector<uint32_t> m_items;          // Entity indices grouped by cell
+};
+
+#endif // FLAT_SPATIAL_GRID_H
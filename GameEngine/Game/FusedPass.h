@@ -0,0 +1,220 @@
+#ifndef FUSED_PASS_H
+#define FUSED_PASS_H
+
+#include "Systems.h"
+#include "ComponentView.h"
+#include <tuple>
+#include <utility>
+
+/**
+ * Binds one step to the column blocks of the archetype being walked.
+ * A step whose components the archetype lacks is skipped for all its rows.
+ */
+template<typename List>
+struct ListSignature;
+
+template<typename... Ts>
+struct ListSignature<ComponentList<Ts...>>
+{
+    static ComponentSignature Get() { return MakeSignature<Ts...>(); }
+};
+
+// Whether a step visits the entities of _archetype: all its Components, none of its Excludes
+template<typename Step>
+bool StepAppliesTo(const Archetype* _archetype)
+{
+    return _archetype->Matches(ListSignature<typename Step::Components>::Get())
+        && !(_archetype->GetSignature() & ListSignature<typename Step::Excludes>::Get()).any();
+}
+
+template<typename Step, typename List = typename Step::Components>
+class FusedStepBinding;
+
+template<typename Step, typename... Ts>
+class FusedStepBinding<Step, ComponentList<Ts...>>
+{
+public:
+    bool Bind(Archetype* _archetype)
+    {
+        m_archetype = StepAppliesTo<Step>(_archetype) ? _archetype : nullptr;
+        return m_archetype != nullptr;
+    }
+
+    void MarkWritten(uint32_t _begin, uint32_t _end, uint32_t _tick) const
+    {
+        if (m_archetype) MarkComponentsWritten<Ts...>(m_archetype, _begin, _end, _tick);
+    }
+
+    void BindBlock(uint32_t _block)
+    {
+        if (m_archetype) m_blocks = std::make_tuple(m_archetype->GetColumn<typename std::remove_const<Ts>::type>()->GetBlock(_block)...);
+    }
+
+    void Run(const Step& _step, const StepContext& _context, Entity* _entity, uint32_t _index) const
+    {
+        if (m_archetype) Run(_step, _context, _entity, _index, std::index_sequence_for<Ts...>());
+    }
+
+private:
+    template<size_t... Is>
+    void Run(const Step& _step, const StepContext& _context, Entity* _entity, uint32_t _index, std::index_sequence<Is...>) const
+    {
+        _step.Run(_context, _entity, std::get<Is>(m_blocks)[_index]...);
+    }
+
+    Archetype* m_archetype = nullptr;
+    std::tuple<Ts*...> m_blocks;
+};
+
+/**
+ * Runs several per-entity steps in one traversal instead of one system each.
+ *
+ *   using PhysicsPass = FusedPass<PhysicsStep, JumpStep, DashStep>;
+ *
+ * Every active entity goes through all steps that apply to it, in the order
+ * listed, before the next entity is visited, so its components are pulled into
+ * cache once per frame rather than once per system. Steps are plain structs
+ * called directly, so the compiler can inline them into the loop.
+ *
+ * This only matches running the steps as separate systems when each step
+ * touches nothing but the entity it is given (events and other thread-safe
+ * calls aside). Reads/writes come from each step's Components (const = read)
+ * plus its DeclareAccess, so the scheduler sees the union of all steps. The
+ * pass's entity filter is what every step's entities share: the components
+ * all steps need and those all steps exclude.
+ *
+ * Rows are split across the JobSystem like ComponentView::ParallelEach.
+ */
+template<typename... Steps>
+class FusedPass : public System
+{
+public:
+    FusedPass()
+    {
+        // No Require: m_archetypes is every archetype, each step picks its own
+        m_access.with.set();
+        m_access.without.set();
+        int expand[] = { 0, (DeclareStep<Steps>(typename Steps::Components()), 0)... };
+        (void)expand;
+    }
+
+    void Initialize(ArchetypeStorage& _storage) override
+    {
+        System::Initialize(_storage);
+        m_storage = &_storage;
+    }
+
+    // Step instance, for steps with settings (e.g. PatrolStep::SetMapWidth)
+    template<typename Step>
+    Step& GetStep() { return std::get<Step>(m_steps); }
+
+    void Update(EntityManager& _manager, float _deltaTime) override
+    {
+        StepContext context = { &_manager, _deltaTime };
+        uint32_t tick = m_storage->GetTick();
+
+        JobSystem& jobs = JobSystem::Instance();
+        uint32_t rowsPerJob = BLOCKS_PER_JOB * COMPONENT_BLOCK_SIZE;
+        if (jobs.IsSingleThreaded() || CountActive() <= rowsPerJob)
+        {
+            for (Archetype* archetype : *m_archetypes)
+                if (AppliesTo(archetype)) RunRange(archetype, 0, archetype->GetActiveCount(), context, tick);
+            return;
+        }
+
+        JobCounter counter;
+        for (Archetype* archetype : *m_archetypes)
+        {
+            if (!AppliesTo(archetype)) continue;
+            uint32_t activeCount = archetype->GetActiveCount();
+            for (uint32_t start = 0; start < activeCount; start += rowsPerJob)
+            {
+                uint32_t end = std::min(activeCount, start + rowsPerJob);
+                jobs.Submit([this, archetype, start, end, context, tick]()
+                {
+                    RunRange(archetype, start, end, context, tick);
+                }, &counter);
+            }
+        }
+        jobs.Wait(&counter);
+    }
+
+private:
+    static constexpr uint32_t BLOCKS_PER_JOB = 4;
+
+    template<typename Step, typename... Ts>
+    void DeclareStep(ComponentList<Ts...>)
+    {
+        int expand[] = { 0, (DeclareComponent<Ts>(std::is_const<Ts>()), 0)... };
+        (void)expand;
+        Step::DeclareAccess(m_access);
+        m_access.with &= MakeSignature<Ts...>();
+        m_access.without &= ListSignature<typename Step::Excludes>::Get();
+    }
+
+    template<typename T>
+    void DeclareComponent(std::true_type) { m_access.reads.set(ComponentTypeID<T>::value); }
+
+    template<typename T>
+    void DeclareComponent(std::false_type) { m_access.writes.set(ComponentTypeID<T>::value); }
+
+    bool AppliesTo(Archetype* _archetype) const
+    {
+        bool applies[] = { false, StepAppliesTo<Steps>(_archetype)... };
+        for (bool step : applies)
+            if (step) return true;
+        return false;
+    }
+
+    uint32_t CountActive() const
+    {
+        uint32_t count = 0;
+        for (Archetype* archetype : *m_archetypes)
+            if (AppliesTo(archetype)) count += archetype->GetActiveCount();
+        return count;
+    }
+
+    // Rows [_begin, _end) of one archetype; _begin is block-aligned
+    void RunRange(Archetype* _archetype, uint32_t _begin, uint32_t _end, const StepContext& _context, uint32_t _tick) const
+    {
+        RunRange(_archetype, _begin, _end, _context, _tick, std::index_sequence_for<Steps...>());
+    }
+
+    template<size_t... Is>
+    void RunRange(Archetype* _archetype, uint32_t _begin, uint32_t _end, const StepContext& _context, uint32_t _tick,
+                  std::index_sequence<Is...>) const
+    {
+        std::tuple<FusedStepBinding<Steps>...> bindings;
+        int bind[] = { 0, (std::get<Is>(bindings).Bind(_archetype), std::get<Is>(bindings).MarkWritten(_begin, _end, _tick), 0)... };
+        (void)bind;
+
+        for (uint32_t row = _begin; row < _end; row += COMPONENT_BLOCK_SIZE)
+        {
+            uint32_t block = row / COMPONENT_BLOCK_SIZE;
+            uint32_t count = std::min(COMPONENT_BLOCK_SIZE, _end - row);
+            int bindBlock[] = { 0, (std::get<Is>(bindings).BindBlock(block), 0)... };
+            (void)bindBlock;
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                // All of this entity's steps, in order, before the next entity
+                Entity* entity = _archetype->GetEntity(row + i);
+                int run[] = { 0, (std::get<Is>(bindings).Run(std::get<Is>(m_steps), _context, entity, i), 0)... };
+                (void)run;
+            }
+        }
+    }
+
+    std::tuple<Steps...> m_steps;
+    ArchetypeStorage* m_storage = nullptr;
+};
+
+template<typename... Steps>
+constexpr uint32_t FusedPass<Steps...>::BLOCKS_PER_JOB;
+
+// Instantiated in Systems.cpp, where the step bodies are visible for inlining
+extern template class FusedPass<PhysicsStep, JumpStep, DashStep>;
+extern template class FusedPass<MovementStep>;
+extern template class FusedPass<PatrolStep>;
+
+#endif // FUSED_PASS_H
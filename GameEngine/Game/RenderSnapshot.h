@@ -0,0 +1,52 @@
+#ifndef RENDER_SNAPSHOT_H
+#define RENDER_SNAPSHOT_H
+
+#include "../Core/StandardIncludes.h"
+
+class Texture;
+class TileMap;
+
+// One sprite to draw; dest is already in screen space and mirrored for left-facing sprites
+struct SpriteInstance
+{
+    Texture* texture;
+    Rect src;
+    Rect dest;
+};
+
+// A visible map chunk and where it sits in the world
+struct ChunkDraw
+{
+    TileMap* tileMap;
+    float worldOffsetX;
+};
+
+/**
+ * Everything needed to draw one frame, copied out of the simulation.
+ *
+ * GameController keeps two: the simulation fills one on a worker while the
+ * main thread draws the other, so drawing never reads live entity or chunk
+ * state. Only pointers to data that outlives the game (textures, tile maps)
+ * are kept.
+ */
+struct RenderSnapshot
+{
+    bool valid = false;         // False until filled, or after the world was reset
+    float cameraX = 0;
+    vector<ChunkDraw> chunks;
+    vector<SpriteInstance> sprites;
+    bool drawEntities = true;   // Off once the player is fully dead
+    int score = 0;
+    int health = 0;
+    int maxHealth = 3;
+
+    // Keeps the vectors' capacity for the next frame
+    void Clear()
+    {
+        valid = false;
+        chunks.clear();
+        sprites.clear();
+    }
+};
+
+#endif // RENDER_SNAPSHOT_H
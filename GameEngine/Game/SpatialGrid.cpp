@@ -1,6 +1,7 @@
 #include "SpatialGrid.h"
 #include "../Graphics/Renderer.h"
 #include "../Graphics/Camera.h"
+#include "../Core/JobSystem.h"
 #include <algorithm>
 
 SpatialGrid::SpatialGrid(int _cellSize)
@@ -10,83 +11,137 @@ SpatialGrid::SpatialGrid(int _cellSize)
 
 void SpatialGrid::Clear()
 {
-    m_cells.clear();
-    m_entityCells.clear();
+    m_static.Clear();
+    m_dynamic.Clear();
 }
 
-std::pair<int, int> SpatialGrid::GetCell(float _x, float _y) const
+SpatialGrid::CellRange SpatialGrid::GetCellRange(Entity* _entity, bool _activeOnly) const
 {
-    return { static_cast<int>(floor(_x / m_cellSize)), 
-             static_cast<int>(floor(_y / m_cellSize)) };
+    CellRange range = {};
+    if (!_entity || (_activeOnly && !_entity->IsActive())) return range;
+    
+    auto* transform = _entity->GetComponent<TransformComponent>();
+    auto* collision = _entity->GetComponent<CollisionComponent>();
+    if (!transform || !collision) return range;
+    
+    float x = transform->worldX + collision->offsetX;
+    float y = transform->worldY + collision->offsetY;
+    
+    range.minX = static_cast<int>(floor(x / m_cellSize));
+    range.maxX = static_cast<int>(floor((x + collision->boxWidth) / m_cellSize));
+    range.minY = static_cast<int>(floor(y / m_cellSize));
+    range.maxY = static_cast<int>(floor((y + collision->boxHeight) / m_cellSize));
+    range.valid = true;
+    return range;
 }
 
-std::vector<std::pair<int, int>> SpatialGrid::GetCellsForAABB(float _x, float _y, float _w, float _h) const
+SpatialGrid::CellRange SpatialGrid::GetRegionRange(float _x, float _y, float _width, float _height) const
 {
-    std::vector<std::pair<int, int>> cells;
+    CellRange range;
+    range.minX = static_cast<int>(floor(_x / m_cellSize));
+    range.maxX = static_cast<int>(floor((_x + _width) / m_cellSize));
+    range.minY = static_cast<int>(floor(_y / m_cellSize));
+    range.maxY = static_cast<int>(floor((_y + _height) / m_cellSize));
+    range.valid = true;
+    return range;
+}
+
+void SpatialGrid::InsertRange(Layer& _layer, Entity* _entity, const CellRange& _range)
+{
+    if (!_range.valid) return;
+    if (_layer.slotOf.count(_entity->GetID())) RemoveFrom(_layer, _entity);
     
-    int minCellX = static_cast<int>(floor(_x / m_cellSize));
-    int maxCellX = static_cast<int>(floor((_x + _w) / m_cellSize));
-    int minCellY = static_cast<int>(floor(_y / m_cellSize));
-    int maxCellY = static_cast<int>(floor((_y + _h) / m_cellSize));
+    uint32_t index;
+    if (!_layer.freeSlots.empty())
+    {
+        index = _layer.freeSlots.back();
+        _layer.freeSlots.pop_back();
+    }
+    else
+    {
+        index = (uint32_t)_layer.slots.size();
+        _layer.slots.emplace_back();
+    }
+    _layer.slotOf[_entity->GetID()] = index;
     
-    for (int cx = minCellX; cx <= maxCellX; ++cx)
+    Slot& slot = _layer.slots[index];
+    slot.entity = _entity;
+    for (int cx = _range.minX; cx <= _range.maxX; ++cx)
     {
-        for (int cy = minCellY; cy <= maxCellY; ++cy)
+        for (int cy = _range.minY; cy <= _range.maxY; ++cy)
         {
-            cells.push_back({ cx, cy });
+            _layer.cells[{ cx, cy }].push_back(index);
+            slot.cells.push_back({ cx, cy });
         }
     }
-    
-    return cells;
 }
 
 void SpatialGrid::Insert(Entity* _entity)
 {
-    if (!_entity || !_entity->IsActive()) return;
-    
-    auto* transform = _entity->GetComponent<TransformComponent>();
-    auto* collision = _entity->GetComponent<CollisionComponent>();
-    if (!transform || !collision) return;
-    
-    float x = transform->worldX + collision->offsetX;
-    float y = transform->worldY + collision->offsetY;
-    float w = collision->boxWidth;
-    float h = collision->boxHeight;
-    
-    auto cells = GetCellsForAABB(x, y, w, h);
-    EntityID id = _entity->GetID();
+    InsertRange(m_dynamic, _entity, GetCellRange(_entity));
+}
+
+void SpatialGrid::InsertStatic(Entity* _entity)
+{
+    InsertRange(m_static, _entity, GetCellRange(_entity, false));
+}
+
+void SpatialGrid::Rebuild(const std::vector<Entity*>& _entities)
+{
+    m_dynamic.Clear();
     
-    for (const auto& cell : cells)
-    {
-        m_cells[cell].push_back(_entity);
-    }
+    // Component lookups and cell math are independent per entity
+    m_rebuildRanges.resize(_entities.size());
+    JobSystem::Instance().ParallelFor((uint32_t)_entities.size(), 256,
+        [this, &_entities](uint32_t _begin, uint32_t _end)
+        {
+            for (uint32_t i = _begin; i < _end; ++i)
+                m_rebuildRanges[i] = GetCellRange(_entities[i]);
+        });
     
-    m_entityCells[id] = cells;
+    for (size_t i = 0; i < _entities.size(); ++i)
+        InsertRange(m_dynamic, _entities[i], m_rebuildRanges[i]);
 }
 
-void SpatialGrid::Remove(Entity* _entity)
+void SpatialGrid::RemoveFrom(Layer& _layer, Entity* _entity)
 {
     if (!_entity) return;
     
     EntityID id = _entity->GetID();
-    auto it = m_entityCells.find(id);
-    if (it == m_entityCells.end()) return;
+    auto it = _layer.slotOf.find(id);
+    if (it == _layer.slotOf.end()) return;
     
-    for (const auto& cell : it->second)
+    uint32_t index = it->second;
+    Slot& slot = _layer.slots[index];
+    for (const auto& cell : slot.cells)
     {
-        auto cellIt = m_cells.find(cell);
-        if (cellIt != m_cells.end())
+        auto cellIt = _layer.cells.find(cell);
+        if (cellIt != _layer.cells.end())
         {
-            auto& entities = cellIt->second;
-            entities.erase(std::remove(entities.begin(), entities.end(), _entity), entities.end());
-            if (entities.empty())
+            // Erase keeps the order of the rest, so query results stay deterministic
+            auto& indices = cellIt->second;
+            indices.erase(std::remove(indices.begin(), indices.end(), index), indices.end());
+            if (indices.empty())
             {
-                m_cells.erase(cellIt);
+                _layer.cells.erase(cellIt);
             }
         }
     }
     
-    m_entityCells.erase(it);
+    slot.entity = nullptr;
+    slot.cells.clear();
+    _layer.freeSlots.push_back(index);
+    _layer.slotOf.erase(it);
+}
+
+void SpatialGrid::Remove(Entity* _entity)
+{
+    RemoveFrom(m_dynamic, _entity);
+}
+
+void SpatialGrid::RemoveStatic(Entity* _entity)
+{
+    RemoveFrom(m_static, _entity);
 }
 
 void SpatialGrid::Update(Entity* _entity)
@@ -95,70 +150,47 @@ void SpatialGrid::Update(Entity* _entity)
     Insert(_entity);
 }
 
-std::vector<Entity*> SpatialGrid::GetNearbyEntities(Entity* _entity) const
+void SpatialGrid::UpdateStatic(Entity* _entity)
 {
-    std::unordered_set<Entity*> nearby;
-    
-    if (!_entity) return {};
-    
-    auto* transform = _entity->GetComponent<TransformComponent>();
-    auto* collision = _entity->GetComponent<CollisionComponent>();
-    if (!transform || !collision) return {};
-    
-    float x = transform->worldX + collision->offsetX;
-    float y = transform->worldY + collision->offsetY;
-    float w = collision->boxWidth;
-    float h = collision->boxHeight;
-    
-    // Get cells for this entity's AABB plus adjacent cells
-    int minCellX = static_cast<int>(floor(x / m_cellSize)) - 1;
-    int maxCellX = static_cast<int>(floor((x + w) / m_cellSize)) + 1;
-    int minCellY = static_cast<int>(floor(y / m_cellSize)) - 1;
-    int maxCellY = static_cast<int>(floor((y + h) / m_cellSize)) + 1;
-    
-    for (int cx = minCellX; cx <= maxCellX; ++cx)
+    RemoveStatic(_entity);
+    InsertStatic(_entity);
+}
+
+uint32_t SpatialGrid::NextQueryStamp() const
+{
+    if (++m_queryStamp == 0)
     {
-        for (int cy = minCellY; cy <= maxCellY; ++cy)
-        {
-            auto it = m_cells.find({ cx, cy });
-            if (it != m_cells.end())
-            {
-                for (Entity* e : it->second)
-                {
-                    if (e != _entity && e->IsActive())
-                    {
-                        nearby.insert(e);
-                    }
-                }
-            }
-        }
+        for (const Layer* layer : { &m_static, &m_dynamic })
+            for (const Slot& slot : layer->slots) slot.stamp = 0;
+        m_queryStamp = 1;
     }
-    
-    return std::vector<Entity*>(nearby.begin(), nearby.end());
+    return m_queryStamp;
+}
+
+void SpatialGrid::GetNearbyEntities(Entity* _entity, std::vector<Entity*>& _out) const
+{
+    _out.clear();
+    ForEachNearby(_entity, [&_out](Entity* _e) { _out.push_back(_e); });
+}
+
+void SpatialGrid::GetEntitiesInRegion(float _x, float _y, float _width, float _height, std::vector<Entity*>& _out) const
+{
+    _out.clear();
+    ForEachInRegion(_x, _y, _width, _height, [&_out](Entity* _e) { _out.push_back(_e); });
+}
+
+std::vector<Entity*> SpatialGrid::GetNearbyEntities(Entity* _entity) const
+{
+    std::vector<Entity*> nearby;
+    GetNearbyEntities(_entity, nearby);
+    return nearby;
 }
 
 std::vector<Entity*> SpatialGrid::GetEntitiesInRegion(float _x, float _y, float _width, float _height) const
 {
-    std::unordered_set<Entity*> result;
-    
-    auto cells = GetCellsForAABB(_x, _y, _width, _height);
-    
-    for (const auto& cell : cells)
-    {
-        auto it = m_cells.find(cell);
-        if (it != m_cells.end())
-        {
-            for (Entity* e : it->second)
-            {
-                if (e->IsActive())
-                {
-                    result.insert(e);
-                }
-            }
-        }
-    }
-    
-    return std::vector<Entity*>(result.begin(), result.end());
+    std::vector<Entity*> result;
+    GetEntitiesInRegion(_x, _y, _width, _height, result);
+    return result;
 }
 
 bool SpatialGrid::AABBOverlap(Entity* _a, Entity* _b)
@@ -214,9 +246,11 @@ void SpatialGrid::RenderDebug(Renderer* _renderer, Camera* _camera, float _viewp
             float screenX = _camera->WorldToScreenX(worldX);
             float screenY = worldY;
             
-            // Check if cell has entities
-            auto it = m_cells.find({ cx, cy });
-            bool hasEntities = (it != m_cells.end() && !it->second.empty());
+            // Check if cell has entities in either layer
+            auto staticIt = m_static.cells.find({ cx, cy });
+            auto dynamicIt = m_dynamic.cells.find({ cx, cy });
+            bool hasEntities = (staticIt != m_static.cells.end() && !staticIt->second.empty()) ||
+                               (dynamicIt != m_dynamic.cells.end() && !dynamicIt->second.empty());
             
             // Green for has entities, red for empty
             if (hasEntities)
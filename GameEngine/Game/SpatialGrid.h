@@ -5,7 +5,6 @@
 #include "Components.h"
 #include <vector>
 #include <unordered_map>
-#include <unordered_set>
 
 class Renderer;
 class Camera;
@@ -19,25 +18,65 @@ class Camera;
  * Two-phase collision:
  * 1. Broad-phase: AABB overlap test (fast rejection)
  * 2. Narrow-phase: Detailed collision (pixel-perfect if needed)
+ *
+ * Entities live in one of two layers that queries search together. The
+ * static layer holds colliders that do not move (coins); they are inserted
+ * once and stay until destroyed or repositioned. The dynamic
+ * layer holds everything that moves and is rebuilt every frame.
  */
 class SpatialGrid
 {
 public:
     SpatialGrid(int _cellSize = 64);
     
-    // Clear all entities from the grid
+    // Clear all entities from both layers
     void Clear();
     
-    // Insert an entity into the grid based on its position and collision box
+    // Insert an entity into the dynamic layer based on its position and collision box
     void Insert(Entity* _entity);
+
+    // Replace the dynamic layer with _entities. Boxes are read and mapped to cells
+    // on the JobSystem, the cell lists are then filled on the calling thread.
+    void Rebuild(const std::vector<Entity*>& _entities);
     
-    // Update entity position in grid (call after movement)
+    // Update entity position in the dynamic layer (call after movement)
     void Update(Entity* _entity);
     
-    // Remove entity from grid
+    // Remove entity from the dynamic layer
     void Remove(Entity* _entity);
+
+    // Static layer: insert once, update after a reposition, remove when the entity
+    // is destroyed. Inactive entities are kept, queries skip them.
+    void InsertStatic(Entity* _entity);
+    void UpdateStatic(Entity* _entity);
+    void RemoveStatic(Entity* _entity);
+    size_t GetStaticCount() const { return m_static.slotOf.size(); }
+    
+    // Call _func(entity) for each active entity in the cells of _entity's box and the
+    // cells around it, once each: static layer first, cells in x then y order, entities
+    // in the order they were filed. Allocates nothing; one query at a time per grid.
+    template<typename Func>
+    void ForEachNearby(Entity* _entity, Func&& _func) const
+    {
+        CellRange cells = GetCellRange(_entity, false);
+        if (!cells.valid) return;
+        --cells.minX; --cells.minY;
+        ++cells.maxX; ++cells.maxY;
+        ForEachInCells(cells, _entity, _func);
+    }
+    
+    // Same for the cells overlapping a world region
+    template<typename Func>
+    void ForEachInRegion(float _x, float _y, float _width, float _height, Func&& _func) const
+    {
+        ForEachInCells(GetRegionRange(_x, _y, _width, _height), nullptr, _func);
+    }
+    
+    // Queries into a caller-owned buffer: _out is cleared and refilled, keeping its capacity
+    void GetNearbyEntities(Entity* _entity, std::vector<Entity*>& _out) const;
+    void GetEntitiesInRegion(float _x, float _y, float _width, float _height, std::vector<Entity*>& _out) const;
     
-    // Get all cells that are likely to collide with an entity (same type + adjacent cells)    
+    // Get all cells that are likely to collide with an entity (same type + adjacent cells), both layers
     std::vector<Entity*> GetNearbyEntities(Entity* _entity) const;
     
     // Get entities in a specific world region
@@ -66,19 +105,73 @@ private:
         }
     };
     
-    // Get cell coordinates for a world position
-    std::pair<int, int> GetCell(float _x, float _y) const;
-    
-    // Get all cells that an AABB overlaps
-    std::vector<std::pair<int, int>> GetCellsForAABB(float _x, float _y, float _w, float _h) const;
+    // Inclusive cell range covered by an entity's collision box
+    struct CellRange
+    {
+        int minX, minY, maxX, maxY;
+        bool valid;
+    };
+    CellRange GetCellRange(Entity* _entity, bool _activeOnly = true) const;
+    CellRange GetRegionRange(float _x, float _y, float _width, float _height) const;
+
+    // A filed entity. Cells list slot indices; the stamp marks the last query that
+    // reported the slot, so a query dedupes without a set.
+    struct Slot
+    {
+        Entity* entity = nullptr;
+        mutable uint32_t stamp = 0;
+        std::vector<std::pair<int, int>> cells;   // For fast removal/update
+    };
+
+    struct Layer
+    {
+        // Map from cell coordinates to the slots in that cell
+        std::unordered_map<std::pair<int, int>, std::vector<uint32_t>, CellHash> cells;
+        std::unordered_map<EntityID, uint32_t> slotOf;
+        std::vector<Slot> slots;
+        std::vector<uint32_t> freeSlots;
+
+        void Clear() { cells.clear(); slotOf.clear(); slots.clear(); freeSlots.clear(); }
+    };
+    void InsertRange(Layer& _layer, Entity* _entity, const CellRange& _range);
+    void RemoveFrom(Layer& _layer, Entity* _entity);
+
+    // Stamp for a new query; restamps every slot on wrap-around
+    uint32_t NextQueryStamp() const;
+
+    template<typename Func>
+    void ForEachInCells(const CellRange& _cells, Entity* _exclude, Func& _func) const
+    {
+        uint32_t stamp = NextQueryStamp();
+        for (const Layer* layer : { &m_static, &m_dynamic })
+        {
+            for (int cx = _cells.minX; cx <= _cells.maxX; ++cx)
+            {
+                for (int cy = _cells.minY; cy <= _cells.maxY; ++cy)
+                {
+                    auto it = layer->cells.find({ cx, cy });
+                    if (it == layer->cells.end()) continue;
+
+                    for (uint32_t index : it->second)
+                    {
+                        const Slot& slot = layer->slots[index];
+                        if (slot.stamp == stamp) continue;
+                        slot.stamp = stamp;
+
+                        Entity* e = slot.entity;
+                        if (e != _exclude && e->IsActive()) _func(e);
+                    }
+                }
+            }
+        }
+    }
     
     int m_cellSize;
-    
-    // Map from cell coordinates to entities in that cell
-    std::unordered_map<std::pair<int, int>, std::vector<Entity*>, CellHash> m_cells;
-    
-    // Track which cells each entity occupies (for fast removal/update)
-    std::unordered_map<EntityID, std::vector<std::pair<int, int>>> m_entityCells;
+    Layer m_static;
+    Layer m_dynamic;
+    mutable uint32_t m_queryStamp = 0;
+
+    std::vector<CellRange> m_rebuildRanges;   // Scratch for Rebuild
 };
 
 #endif // SPATIALGRID_H
@@ -0,0 +1,117 @@
+#include "SweepAndPrune.h"
+#include <algorithm>
+#include <cmath>
+
+void SweepAndPrune::Update(const std::vector<Entity*>& _entities, const ColliderCache& _cache)
+{
+    Sync(_entities);
+    RefreshBoxes(_cache);
+    Sort();
+    Sweep();
+}
+
+void SweepAndPrune::Clear()
+{
+    m_proxies.clear();
+    m_sorted.Clear();
+    m_marks.clear();
+    m_pairs.clear();
+    m_frame = 0;
+    m_appended = 0;
+    m_lastSortMoves = 0;
+}
+
+void SweepAndPrune::Sync(const std::vector<Entity*>& _entities)
+{
+    ++m_frame;
+    for (Entity* entity : _entities)
+    {
+        uint32_t index = GetEntityIndex(entity->GetID());
+        if (index >= m_marks.size()) m_marks.resize(index + 1);
+
+        Mark& mark = m_marks[index];
+        mark.frame = m_frame;
+        mark.id = entity->GetID();
+        mark.filed = false;
+    }
+
+    // Keep the proxies of entities passed in again, in their sorted order
+    size_t kept = 0;
+    for (const Proxy& proxy : m_proxies)
+    {
+        Mark& mark = m_marks[GetEntityIndex(proxy.id)];
+        if (mark.frame != m_frame || mark.id != proxy.id || mark.filed) continue;
+        mark.filed = true;
+        m_proxies[kept++] = proxy;
+    }
+    m_proxies.resize(kept);
+
+    // New ones go on the end for the sort to place
+    m_appended = 0;
+    for (Entity* entity : _entities)
+    {
+        Mark& mark = m_marks[GetEntityIndex(entity->GetID())];
+        if (mark.filed) continue;
+        mark.filed = true;
+        m_proxies.push_back({ ColliderBoxes::EMPTY_BOX, entity, entity->GetID() });
+        ++m_appended;
+    }
+}
+
+void SweepAndPrune::RefreshBoxes(const ColliderCache& _cache)
+{
+    for (Proxy& proxy : m_proxies)
+    {
+        uint32_t slot = _cache.Find(proxy.entity);
+        proxy.box = slot != ColliderCache::NONE ? _cache.GetBox(slot) : ColliderBoxes::EMPTY_BOX;
+    }
+}
+
+void SweepAndPrune::Sort()
+{
+    m_lastSortMoves = 0;
+
+    // A large batch of new proxies (first frame, a chunk streaming in) sits far from
+    // its place, which is insertion sort's worst case
+    if (m_appended > 64 && m_appended * 4 > m_proxies.size())
+    {
+        std::sort(m_proxies.begin(), m_proxies.end(),
+            [](const Proxy& _a, const Proxy& _b) { return _a.box.minX < _b.box.minX; });
+        return;
+    }
+
+    for (size_t i = 1; i < m_proxies.size(); ++i)
+    {
+        Proxy proxy = m_proxies[i];
+        size_t j = i;
+        while (j > 0 && m_proxies[j - 1].box.minX > proxy.box.minX)
+        {
+            m_proxies[j] = m_proxies[j - 1];
+            --j;
+        }
+        m_lastSortMoves += (uint32_t)(i - j);
+        m_proxies[j] = proxy;
+    }
+}
+
+void SweepAndPrune::Sweep()
+{
+    uint32_t count = (uint32_t)m_proxies.size();
+    m_sorted.Resize(count);
+    for (uint32_t i = 0; i < count; ++i)
+        m_sorted.Set(i, m_proxies[i].box);
+
+    m_pairs.clear();
+    const float* minX = m_sorted.GetMinX();
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const Proxy& a = m_proxies[i];
+
+        // Candidates are the boxes after a that start before it ends
+        uint32_t end = (uint32_t)(std::lower_bound(minX + i + 1, minX + count, a.box.maxX) - minX);
+        m_sorted.ForEachOverlap(a.box, i + 1, end, [this, &a](uint32_t _j)
+        {
+            m_pairs.push_back({ a.entity, m_proxies[_j].entity });
+        });
+    }
+}
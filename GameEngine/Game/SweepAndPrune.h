@@ -0,0 +1,79 @@
+#ifndef SWEEP_AND_PRUNE_H
+#define SWEEP_AND_PRUNE_H
+
+#include "Entity.h"
+#include "Components.h"
+#include "ColliderCache.h"
+#include <vector>
+
+// Two colliders whose boxes overlap; a starts no further right than b
+struct CollisionPair
+{
+    Entity* a;
+    Entity* b;
+};
+
+/**
+ * Sort-and-sweep broad phase on the x axis for colliders that all move.
+ *
+ * Keeps one box per collider in a list sorted by left edge. Most motion in
+ * a side-scroller is horizontal and small per frame, so last frame's order
+ * is nearly right and an insertion sort restores it in close to one pass.
+ * The sweep then walks the list once: each box is only tested against the
+ * boxes that start before it ends, and those that also overlap on y become
+ * pairs. Cost is the colliders plus the boxes sharing an x span, not every
+ * pair, so thousands of enemies stay cheap. Boxes come from the frame's
+ * ColliderCache, and each box's run of candidates is tested a batch at a
+ * time with the ColliderBoxes overlap kernel.
+ *
+ * Update() is given the current colliders each frame. Colliders that are
+ * gone are dropped, new ones appended, then the list is re-sorted; a large
+ * batch of new ones is sorted outright instead.
+ */
+class SweepAndPrune
+{
+public:
+    // Sync to _entities (active colliders, all in _cache) and find this frame's pairs
+    void Update(const std::vector<Entity*>& _entities, const ColliderCache& _cache);
+
+    void Clear();
+
+    // Overlapping pairs from the last Update(), in sweep order
+    const std::vector<CollisionPair>& GetPairs() const { return m_pairs; }
+
+    uint32_t GetProxyCount() const { return (uint32_t)m_proxies.size(); }
+
+    // Insertion sort moves in the last Update(), a measure of how unsorted the list got
+    uint32_t GetLastSortMoves() const { return m_lastSortMoves; }
+
+private:
+    struct Proxy
+    {
+        ColliderBox box;
+        Entity* entity;
+        EntityID id;        // Kept so a destroyed entity is recognised without touching it
+    };
+
+    // Per entity index: the frame it was last passed to Update() and whether it has a proxy
+    struct Mark
+    {
+        uint32_t frame = 0;
+        EntityID id = INVALID_ENTITY;
+        bool filed = false;
+    };
+
+    void Sync(const std::vector<Entity*>& _entities);
+    void RefreshBoxes(const ColliderCache& _cache);
+    void Sort();
+    void Sweep();
+
+    std::vector<Proxy> m_proxies;   // Sorted by minX after Update()
+    ColliderBoxes m_sorted;         // m_proxies' boxes, for the sweep
+    std::vector<Mark> m_marks;
+    std::vector<CollisionPair> m_pairs;
+    uint32_t m_frame = 0;
+    size_t m_appended = 0;          // Proxies added by the last Sync()
+    uint32_t m_lastSortMoves = 0;
+};
+
+#endif // SWEEP_AND_PRUNE_H
@@ -0,0 +1,56 @@
+#include "SystemScheduler.h"
+#include "../Core/JobSystem.h"
+
+void SystemScheduler::Add(System* _system)
+{
+    Node node;
+    node.system = _system;
+    m_nodes.push_back(node);
+}
+
+void SystemScheduler::Build()
+{
+    for (auto& node : m_nodes)
+    {
+        node.dependents.clear();
+        node.dependencyCount = 0;
+    }
+
+    for (size_t i = 0; i < m_nodes.size(); ++i)
+    {
+        for (size_t j = i + 1; j < m_nodes.size(); ++j)
+        {
+            if (m_nodes[i].system->GetAccess().ConflictsWith(m_nodes[j].system->GetAccess()))
+            {
+                m_nodes[i].dependents.push_back(j);
+                m_nodes[j].dependencyCount++;
+            }
+        }
+    }
+
+    m_remaining = std::vector<std::atomic<int>>(m_nodes.size());
+}
+
+void SystemScheduler::Run(EntityManager& _manager, float _deltaTime)
+{
+    for (size_t i = 0; i < m_nodes.size(); ++i)
+        m_remaining[i].store(m_nodes[i].dependencyCount);
+
+    JobCounter counter;
+    for (size_t i = 0; i < m_nodes.size(); ++i)
+        if (m_nodes[i].dependencyCount == 0) Submit(i, _manager, _deltaTime, &counter);
+
+    JobSystem::Instance().Wait(&counter);
+}
+
+void SystemScheduler::Submit(size_t _index, EntityManager& _manager, float _deltaTime, JobCounter* _counter)
+{
+    JobSystem::Instance().Submit([this, _index, &_manager, _deltaTime, _counter]()
+    {
+        m_nodes[_index].system->Update(_manager, _deltaTime);
+
+        // Release dependents whose last dependency just finished
+        for (size_t dependent : m_nodes[_index].dependents)
+            if (m_remaining[dependent].fetch_sub(1) == 1) Submit(dependent, _manager, _deltaTime, _counter);
+    }, _counter);
+}
@@ -0,0 +1,43 @@
+#ifndef SYSTEM_SCHEDULER_H
+#define SYSTEM_SCHEDULER_H
+
+#include "Systems.h"
+#include <atomic>
+
+struct JobCounter;
+
+/**
+ * Runs systems as a dependency graph on the JobSystem.
+ *
+ * Systems are added in their logical order. Build() adds an edge from every
+ * earlier system to every later one whose declared access conflicts with it,
+ * so conflicting systems keep their order while disjoint ones run at the same
+ * time.
+ */
+class SystemScheduler
+{
+public:
+    void Add(System* _system);
+    void Build();
+
+    // Run every system once and return when all have finished
+    void Run(EntityManager& _manager, float _deltaTime);
+
+    size_t GetSystemCount() const { return m_nodes.size(); }
+    const std::vector<size_t>& GetDependents(size_t _index) const { return m_nodes[_index].dependents; }
+
+private:
+    struct Node
+    {
+        System* system;
+        std::vector<size_t> dependents;
+        int dependencyCount = 0;
+    };
+
+    void Submit(size_t _index, EntityManager& _manager, float _deltaTime, JobCounter* _counter);
+
+    std::vector<Node> m_nodes;
+    std::vector<std::atomic<int>> m_remaining;   // Unfinished dependencies per node this run
+};
+
+#endif // SYSTEM_SCHEDULER_H
@@ -1,34 +1,73 @@
 #include "Systems.h"
+#include "FusedPass.h"
 #include "SpatialGrid.h"
 #include "ChunkMap.h"
+#include "EntityManager.h"
 #include "../Graphics/Renderer.h"
 #include "../Graphics/Camera.h"
-#include "../Core/Timing.h"
-#include "../Audio/GameAudioManager.h"
 
-void InputSystem::Update(std::vector<Entity*>& _entities, float _deltaTime)
+// Row of an optional column, nullptr when the archetype does not store that component
+template<typename T>
+static T* RowOrNull(TypedColumn<T>* _column, uint32_t _row)
+{
+    return _column ? _column->Get(_row) : nullptr;
+}
+
+// The player if it is active and stores every component the system requires
+static Entity* GetActivePlayer(EntityManager& _manager, const ComponentSignature& _required)
+{
+    Entity* player = _manager.GetStorage().GetSingleton<PlayerTag>();
+    if (!player || !player->IsActive() || !player->GetArchetype()->Matches(_required)) return nullptr;
+    return player;
+}
+
+SimLodTier SimLod::TierOf(float _left, float _right) const
+{
+    if (!enabled) return SimLodTier::Full;
+
+    // Gap between the entity and the view, 0 when they overlap
+    float viewWidth = viewRight - viewLeft;
+    float distance = std::max(0.0f, std::max(_left - viewRight, viewLeft - _right));
+    if (distance <= 64.0f) return SimLodTier::Full;
+    if (distance <= viewWidth * 0.5f) return SimLodTier::Half;
+    if (distance <= viewWidth) return SimLodTier::Quarter;
+    return SimLodTier::Far;
+}
+
+bool SimLod::IsDue(SimLodTier _tier, uint32_t _phase) const
+{
+    switch (_tier)
+    {
+        case SimLodTier::Full: return true;
+        case SimLodTier::Half: return ((tick + _phase) & 1) == 0;
+        case SimLodTier::Quarter: return ((tick + _phase) & 3) == 0;
+        default: return false;
+    }
+}
+
+void InputSystem::Update(EntityManager& _manager, float _deltaTime)
 {
     const Uint8* keys = SDL_GetKeyboardState(NULL);
-    for (auto* entity : _entities)
+    for (Entity* entity : _manager.GetStorage().GetIndexed<InputComponent>())
     {
-        if (!entity || !entity->IsActive() || !entity->HasComponent<PlayerTag>()) continue;
+        if (!entity->IsActive()) continue;
         auto* movement = entity->GetComponent<MovementComponent>();
+        if (!movement) continue;
         auto* sprite = entity->GetComponent<SpriteComponent>();
         auto* jump = entity->GetComponent<JumpComponent>();
         auto* dash = entity->GetComponent<DashComponent>();
         auto* punch = entity->GetComponent<PunchComponent>();
-        if (!movement) continue;
 
         bool shift = keys[SDL_SCANCODE_LSHIFT] || keys[SDL_SCANCODE_RSHIFT];
-        
+
         // Dash - shift press
         if (dash)
         {
             static bool prevShift = false;
             bool shiftJustPressed = shift && !prevShift;
             prevShift = shift;
-            
-            if (shiftJustPressed && !dash->isDashing && dash->cooldownTimer <= 0)
+
+            if (shiftJustPressed && !dash->isDashing && !dash->onCooldown)
             {
                 dash->dashPressed = true;
             }
@@ -42,7 +81,7 @@ void InputSystem::Update(std::vector<Entity*>& _entities, float _deltaTime)
             bool leftClick = (mouseState & SDL_BUTTON(SDL_BUTTON_LEFT)) != 0;
             bool clickJustPressed = leftClick && !prevClick;
             prevClick = leftClick;
-            
+
             if (clickJustPressed)
             {
                 punch->punchPressed = true;
@@ -62,201 +101,163 @@ void InputSystem::Update(std::vector<Entity*>& _entities, float _deltaTime)
     }
 }
 
-void PhysicsSystem::Update(std::vector<Entity*>& _entities, float _deltaTime)
+void PhysicsStep::Run(const StepContext& _context, Entity* _entity, MovementComponent& _movement, const PhysicsComponent& _physics) const
 {
-    for (auto* entity : _entities)
-    {
-        if (!entity || !entity->IsActive()) continue;
-        auto* movement = entity->GetComponent<MovementComponent>();
-        auto* physics = entity->GetComponent<PhysicsComponent>();
-        if (movement && physics && physics->useGravity)
-            movement->velocityY += physics->gravity * _deltaTime;
-    }
+    _movement.velocityY += _physics.useGravity ? _physics.gravity * _context.deltaTime : 0.0f;
 }
 
-void JumpSystem::Update(std::vector<Entity*>& _entities, float _deltaTime)
+void JumpStep::Run(const StepContext& _context, Entity* _entity, MovementComponent& _movement, PhysicsComponent& _physics, JumpComponent& _jump) const
 {
-    for (auto* entity : _entities)
-    {
-        if (!entity || !entity->IsActive()) continue;
-        auto* movement = entity->GetComponent<MovementComponent>();
-        auto* physics = entity->GetComponent<PhysicsComponent>();
-        auto* jump = entity->GetComponent<JumpComponent>();
-        if (!movement || !physics || !jump) continue;
+    TimerWheel& timers = _context.manager->GetTimers();
 
-        jump->coyoteTimer = physics->isGrounded ? jump->coyoteTime : jump->coyoteTimer - _deltaTime;
+    // Coyote window: open while grounded, closes coyoteTime after leaving the ground
+    if (_physics.isGrounded)
+    {
+        _jump.canCoyoteJump = true;
+        timers.Cancel(_jump.coyoteEnd);
+    }
+    else if (_jump.canCoyoteJump && _jump.coyoteEnd == INVALID_TIMER)
+    {
+        timers.Start(_jump.coyoteEnd, _entity->GetID(), TimerKind::CoyoteEnd, _jump.coyoteTime);
+    }
 
-        if (jump->jumpPressed)
+    if (_jump.jumpPressed)
+    {
+        if (!_jump.isJumping && (_physics.isGrounded || _jump.canCoyoteJump))
         {
-            if (!jump->isJumping && (physics->isGrounded || jump->coyoteTimer > 0))
-            {
-                jump->isJumping = true;
-                physics->isGrounded = false;
-                movement->velocityY = jump->jumpForce;
-                jump->jumpHoldTimer = jump->jumpMaxHoldTime;
-                
-                // Play player jump sound
-                GameAudioManager::Instance().PlayPlayerJumpSound();
-            }
-            if (jump->isJumping && jump->jumpHoldTimer > 0)
-            {
-                movement->velocityY += jump->jumpHoldForce * _deltaTime;
-                jump->jumpHoldTimer -= _deltaTime;
-            }
+            _jump.isJumping = true;
+            _jump.canCoyoteJump = false;
+            timers.Cancel(_jump.coyoteEnd);
+            _physics.isGrounded = false;
+            _movement.velocityY = _jump.jumpForce;
+            _jump.isHolding = true;
+            timers.Start(_jump.holdEnd, _entity->GetID(), TimerKind::JumpHoldEnd, _jump.jumpMaxHoldTime);
+
+            _context.manager->GetEvents().Emit(GameEventType::PlayerJumped, _entity->GetID());
         }
+        if (_jump.isJumping && _jump.isHolding)
+            _movement.velocityY += _jump.jumpHoldForce * _context.deltaTime;
     }
 }
 
-void DashSystem::Update(std::vector<Entity*>& _entities, float _deltaTime)
+void DashStep::Run(const StepContext& _context, Entity* _entity, MovementComponent& _movement, DashComponent& _dash) const
 {
-    for (auto* entity : _entities)
+    // Start dash; the DashEnd timer stops it and starts the cooldown
+    if (_dash.dashPressed && !_dash.isDashing && !_dash.onCooldown)
     {
-        if (!entity || !entity->IsActive()) continue;
-        auto* movement = entity->GetComponent<MovementComponent>();
-        auto* sprite = entity->GetComponent<SpriteComponent>();
-        auto* dash = entity->GetComponent<DashComponent>();
-        if (!movement || !dash) continue;
-
-        // Update cooldown timer
-        if (dash->cooldownTimer > 0)
-            dash->cooldownTimer -= _deltaTime;
+        _dash.isDashing = true;
+        _context.manager->GetTimers().Start(_dash.dashEnd, _entity->GetID(), TimerKind::DashEnd, _dash.dashDuration);
+        _dash.dashPressed = false;
 
-        // Start dash
-        if (dash->dashPressed && !dash->isDashing && dash->cooldownTimer <= 0)
-        {
-            dash->isDashing = true;
-            dash->dashTimer = dash->dashDuration;
-            dash->dashPressed = false;
-            
-            // Play dash sound
-            GameAudioManager::Instance().PlayDashSound();
-            
-            // Dash in facing direction
-            float direction = (sprite && !sprite->facingRight) ? -1.0f : 1.0f;
-            movement->velocityX = dash->dashSpeed * direction;
-            movement->velocityY = 0;  // Cancel vertical movement during dash
-        }
+        _context.manager->GetEvents().Emit(GameEventType::PlayerDashed, _entity->GetID());
 
-        // Update dash
-        if (dash->isDashing)
-        {
-            dash->dashTimer -= _deltaTime;
-            if (dash->dashTimer <= 0)
-            {
-                dash->isDashing = false;
-                dash->cooldownTimer = dash->dashCooldown;
-                movement->velocityX = 0;
-            }
-        }
-        
-        dash->dashPressed = false;
+        // Dash in facing direction
+        auto* sprite = _entity->GetComponent<SpriteComponent>();
+        float direction = (sprite && !sprite->facingRight) ? -1.0f : 1.0f;
+        _movement.velocityX = _dash.dashSpeed * direction;
+        _movement.velocityY = 0;  // Cancel vertical movement during dash
     }
+
+    _dash.dashPressed = false;
+}
+
+void PunchSystem::Initialize(ArchetypeStorage& _storage)
+{
+    System::Initialize(_storage);
+    m_enemyArchetypes = &_storage.GetQuery(MakeSignature<EnemyComponent, TransformComponent>());
 }
 
-void PunchSystem::Update(std::vector<Entity*>& _entities, float _deltaTime)
+void PunchSystem::Update(EntityManager& _manager, float _deltaTime)
 {
-    // Find player
-    Entity* player = nullptr;
-    for (auto* entity : _entities)
-        if (entity && entity->IsActive() && entity->HasComponent<PlayerTag>()) { player = entity; break; }
+    Entity* player = GetActivePlayer(_manager, m_signature);
     if (!player) return;
 
     auto* punch = player->GetComponent<PunchComponent>();
     auto* transform = player->GetComponent<TransformComponent>();
     auto* sprite = player->GetComponent<SpriteComponent>();
     auto* movement = player->GetComponent<MovementComponent>();
-    if (!punch || !transform) return;
 
-    // Start punch
+    // Start punch; the PunchEnd timer ends it
     if (punch->punchPressed && !punch->isPunching)
     {
         punch->isPunching = true;
-        punch->punchTimer = punch->punchDuration;
+        _manager.GetTimers().Start(punch->punchEnd, player->GetID(), TimerKind::PunchEnd, punch->punchDuration);
         punch->hasHit = false;
         punch->punchPressed = false;
-        
+
         // Stop movement during punch
         if (movement) movement->velocityX = 0;
-        
-        // Play punch sound
-        GameAudioManager::Instance().PlayPunchSound();
+
+        _manager.GetEvents().Emit(GameEventType::PlayerPunched, player->GetID());
     }
 
-    // Update punch
-    if (punch->isPunching)
+    // Check for enemy hits (only once per punch)
+    if (punch->isPunching && !punch->hasHit)
     {
-        punch->punchTimer -= _deltaTime;
-        
-        // Check for enemy hits (only once per punch)
-        if (!punch->hasHit)
+        float playerCenterX = transform->worldX + transform->width / 2;
+        float playerCenterY = transform->worldY + transform->height / 2;
+        float direction = (sprite && !sprite->facingRight) ? -1.0f : 1.0f;
+
+        for (Archetype* archetype : *m_enemyArchetypes)
         {
-            float playerCenterX = transform->worldX + transform->width / 2;
-            float playerCenterY = transform->worldY + transform->height / 2;
-            float direction = (sprite && !sprite->facingRight) ? -1.0f : 1.0f;
-            
-            for (auto* entity : _entities)
+            auto* enemies = archetype->GetColumn<EnemyComponent>();
+            auto* enemyTransforms = archetype->GetColumn<TransformComponent>();
+
+            // Rows past the active count are dormant; IsActive catches enemies deactivated this tick
+            for (uint32_t i = 0; i < archetype->GetActiveCount() && !punch->hasHit; ++i)
             {
-                if (!entity || !entity->IsActive() || entity == player) continue;
-                auto* enemy = entity->GetComponent<EnemyComponent>();
-                if (!enemy || enemy->destroyed) continue;
-                
-                auto* enemyTransform = entity->GetComponent<TransformComponent>();
-                if (!enemyTransform) continue;
-                
+                Entity* entity = archetype->GetEntity(i);
+                if (!entity->IsActive() || entity == player) continue;
+                auto* enemy = enemies->Get(i);
+                if (enemy->destroyed) continue;
+
+                auto* enemyTransform = enemyTransforms->Get(i);
                 float enemyCenterX = enemyTransform->worldX + enemyTransform->width / 2;
                 float enemyCenterY = enemyTransform->worldY + enemyTransform->height / 2;
-                
+
                 // Check if enemy is in facing direction
                 float dx = enemyCenterX - playerCenterX;
                 if ((direction > 0 && dx < 0) || (direction < 0 && dx > 0)) continue;
-                
+
                 float dy = enemyCenterY - playerCenterY;
                 float dist = sqrt(dx * dx + dy * dy);
-                
+
                 // Only hit if within range
                 if (dist <= punch->punchRange)
                 {
                     enemy->destroyed = true;
                     entity->SetActive(false);
                     punch->hasHit = true;
-                    break;
                 }
             }
-        }
-        
-        if (punch->punchTimer <= 0)
-        {
-            punch->isPunching = false;
+            if (punch->hasHit) break;
         }
     }
-    
+
     punch->punchPressed = false;
 }
 
-void MovementSystem::Update(std::vector<Entity*>& _entities, float _deltaTime)
+void MovementStep::Run(const StepContext& _context, Entity* _entity, TransformComponent& _transform, const MovementComponent& _movement) const
 {
-    for (auto* entity : _entities)
-    {
-        if (!entity || !entity->IsActive()) continue;
-        auto* transform = entity->GetComponent<TransformComponent>();
-        auto* movement = entity->GetComponent<MovementComponent>();
-        if (transform && movement)
-        {
-            transform->worldX += movement->velocityX * _deltaTime;
-            transform->worldY += movement->velocityY * _deltaTime;
-        }
-    }
+    _transform.worldX += _movement.velocityX * _context.deltaTime;
+    _transform.worldY += _movement.velocityY * _context.deltaTime;
 }
 
-void CollisionSystem::Update(std::vector<Entity*>& _entities, float _deltaTime)
+void CollisionSystem::Update(EntityManager& _manager, float _deltaTime)
 {
     if (!m_chunkMap) return;
-    for (auto* entity : _entities)
+    for (Archetype* archetype : *m_archetypes)
     {
-        if (!entity || !entity->IsActive()) continue;
-        auto* collision = entity->GetComponent<CollisionComponent>();
-        if (collision && !collision->isTrigger && collision->type == ColliderType::Player)
-            HandlePlayerCollision(entity);
+        auto* collisions = archetype->GetColumn<CollisionComponent>();
+
+        for (uint32_t i = 0; i < archetype->GetActiveCount(); ++i)
+        {
+            Entity* entity = archetype->GetEntity(i);
+            if (!entity->IsActive()) continue;  // Deactivated since the last partition
+            auto* collision = collisions->Get(i);
+            if (!collision->isTrigger && collision->type == ColliderType::Player)
+                HandlePlayerCollision(entity);
+        }
     }
 }
 
@@ -268,6 +269,7 @@ void CollisionSystem::HandlePlayerCollision(Entity* _entity)
     auto* collision = _entity->GetComponent<CollisionComponent>();
     auto* jump = _entity->GetComponent<JumpComponent>();
     if (!transform || !movement || !collision) return;
+    _entity->MarkChanged<TransformComponent>();   // Snapped against tiles below
 
     float colX = transform->worldX + collision->offsetX;
     float colY = transform->worldY + collision->offsetY;
@@ -317,37 +319,49 @@ void CollisionSystem::HandlePlayerCollision(Entity* _entity)
         {
             transform->worldY = ceilY - collision->offsetY;
             movement->velocityY = 0;
-            if (jump) jump->jumpHoldTimer = 0;
+            if (jump) jump->isHolding = false;
         }
     }
 }
 
-void PatrolSystem::Update(std::vector<Entity*>& _entities, float _deltaTime)
+// Walk _distance along a patrol between _left and _right, bouncing off the ends
+static void AdvancePatrol(float& _x, float& _direction, float _distance, float _left, float _right)
 {
-    for (auto* entity : _entities)
-    {
-        if (!entity || !entity->IsActive()) continue;
-        auto* transform = entity->GetComponent<TransformComponent>();
-        auto* movement = entity->GetComponent<MovementComponent>();
-        auto* patrol = entity->GetComponent<PatrolComponent>();
-        if (!transform || !movement || !patrol) continue;
+    float width = _right - _left;
+    if (width <= 0) { _x = _left; return; }
+
+    // Position on one out-and-back lap of length 2 * width, walked forwards
+    float x = std::min(std::max(_x, _left), _right) - _left;
+    float lap = _direction > 0 ? x : 2 * width - x;
+    lap = fmod(lap + _distance, 2 * width);
+    _direction = lap < width ? 1.0f : -1.0f;
+    _x = _left + (lap < width ? lap : 2 * width - lap);
+}
 
-        float offset = transform->mapInstance * m_mapWidth;
-        float leftBound = patrol->baseLeftBoundary + offset;
-        float rightBound = patrol->baseRightBoundary + offset;
+void PatrolStep::Run(const StepContext& _context, Entity* _entity, TransformComponent& _transform, MovementComponent& _movement, PatrolComponent& _patrol) const
+{
+    const SimLod& lod = _context.manager->GetSimLod();
+    SimLodTier tier = lod.TierOf(_transform.worldX, _transform.worldX + _transform.width * _transform.scale);
+    if (!lod.IsDue(tier, GetEntityIndex(_entity->GetID()))) return;
 
-        transform->worldX += movement->moveSpeed * movement->direction * _deltaTime;
-        if (transform->worldX >= rightBound)
-        {
-            movement->direction = -1;
-            transform->worldX = rightBound;
-        }
-        else if (transform->worldX <= leftBound)
-        {
-            movement->direction = 1;
-            transform->worldX = leftBound;
-        }
+    // One tick when updated every tick; longer after skipped ticks or dormancy
+    float elapsed = _patrol.lastUpdateTime < 0 ? _context.deltaTime : (float)(lod.time - _patrol.lastUpdateTime);
+    _patrol.lastUpdateTime = lod.time;
+
+    float offset = _transform.mapInstance * (float)m_mapWidth;
+    float leftBound = _patrol.baseLeftBoundary + offset;
+    float rightBound = _patrol.baseRightBoundary + offset;
+
+    if (elapsed > _context.deltaTime * 1.5f)
+    {
+        AdvancePatrol(_transform.worldX, _movement.direction, _movement.moveSpeed * elapsed, leftBound, rightBound);
+        return;
     }
+
+    // Clamp to the patrol range and turn around at either end
+    float x = _transform.worldX + _movement.moveSpeed * _movement.direction * elapsed;
+    _movement.direction = x >= rightBound ? -1 : (x <= leftBound ? 1 : _movement.direction);
+    _transform.worldX = std::min(std::max(x, leftBound), rightBound);
 }
 
 void ScrollSystem::SetParams(float _cameraX, int _screenWidth, int _mapWidth)
@@ -357,100 +371,101 @@ void ScrollSystem::SetParams(float _cameraX, int _screenWidth, int _mapWidth)
     m_mapWidth = _mapWidth;
 }
 
-void ScrollSystem::Update(std::vector<Entity*>& _entities, float _deltaTime)
+void ScrollSystem::Update(EntityManager& _manager, float _deltaTime)
 {
     if (m_mapWidth == 0) return;
-    for (auto* entity : _entities)
+    for (Archetype* archetype : *m_archetypes)
     {
-        if (!entity || !entity->IsActive()) continue;
-        auto* transform = entity->GetComponent<TransformComponent>();
-        auto* scrollable = entity->GetComponent<ScrollableComponent>();
-        if (!transform || !scrollable || !scrollable->shouldReposition) continue;
+        auto* transforms = archetype->GetColumn<TransformComponent>();
+        auto* scrollables = archetype->GetColumn<ScrollableComponent>();
 
-        if (transform->worldX + transform->width < m_cameraX - 50)
+        for (uint32_t i = 0; i < archetype->GetActiveCount(); ++i)
         {
-            float ahead = m_cameraX + m_screenWidth + 100;
-            int instance = (int)floor(ahead / m_mapWidth);
-            if (instance <= transform->mapInstance) instance = transform->mapInstance + 1;
-            transform->mapInstance = instance;
-            transform->worldX = transform->baseX + instance * m_mapWidth;
-            transform->worldY = transform->baseY;
-            entity->SetActive(true);
-            if (scrollable->onReposition) scrollable->onReposition(entity);
-        }
-    }
-}
+            Entity* entity = archetype->GetEntity(i);
+            if (!entity->IsActive()) continue;  // Deactivated since the last partition
+            auto* transform = transforms->Get(i);
+            auto* scrollable = scrollables->Get(i);
+            if (!scrollable->shouldReposition) continue;
 
-void HealthSystem::Update(std::vector<Entity*>& _entities, float _deltaTime)
-{
-    for (auto* entity : _entities)
-    {
-        if (!entity || !entity->IsActive()) continue;
-        auto* health = entity->GetComponent<HealthComponent>();
-        if (!health) continue;
-
-        if (health->isDead)
-        {
-            health->deathTimer += _deltaTime;
-            if (health->deathTimer >= health->deathDuration) health->isFullyDead = true;
-        }
-        else if (health->isInvincible)
-        {
-            health->invincibleTimer -= _deltaTime;
-            if (health->invincibleTimer <= 0)
+            if (transform->worldX + transform->width < m_cameraX - 50)
             {
-                health->isInvincible = false;
-                health->invincibleTimer = 0;
+                float ahead = m_cameraX + m_screenWidth + 100;
+                int instance = (int)floor(ahead / m_mapWidth);
+                if (instance <= transform->mapInstance) instance = transform->mapInstance + 1;
+                transform->mapInstance = instance;
+                transform->worldX = transform->baseX + instance * m_mapWidth;
+                transform->worldY = transform->baseY;
+                transform->interpolate = false;
+                entity->MarkChanged<TransformComponent>();
+                entity->SetActive(true);
+                if (scrollable->onReposition) scrollable->onReposition(entity);
             }
         }
     }
 }
 
-void EntityCollisionSystem::Update(std::vector<Entity*>& _entities, float _deltaTime)
+// Colliders without a MovementComponent never move on their own (coins)
+static bool IsStaticCollider(const Archetype* _archetype)
 {
-    m_score = 0;
+    return !_archetype->Has(ComponentTypeID<MovementComponent>::value);
+}
+
+void EntityCollisionSystem::Update(EntityManager& _manager, float _deltaTime)
+{
+    // Bring the spatial grid up to date after all movement is done
+    UpdateGrid(_manager);
+
+    m_colliders.Refresh(*m_colliderArchetypes);
+
+    // Moving colliders against each other, only if some pair has a handler to act on
+    // them; the hashed grid left them in m_gridEntities
+    if (m_hasPairHandlers)
+    {
+        if (m_gridBackend == GridBackend::Flat) CollectColliders(true);
+        m_sweep.Update(m_gridEntities, m_colliders);
+        ResolvePairs();
+    }
+
     m_lastBroadPhaseChecks = 0;
     m_lastNarrowPhaseChecks = 0;
-    
-    Entity* player = nullptr;
-    for (auto* entity : _entities)
-        if (entity && entity->IsActive() && entity->HasComponent<PlayerTag>()) { player = entity; break; }
+
+    Entity* player = GetActivePlayer(_manager, m_signature);
     if (!player) return;
 
     auto* playerTransform = player->GetComponent<TransformComponent>();
     auto* playerCollision = player->GetComponent<CollisionComponent>();
     auto* playerMovement = player->GetComponent<MovementComponent>();
     auto* playerHealth = player->GetComponent<HealthComponent>();
-    if (!playerTransform || !playerCollision) return;
 
     float playerX = playerTransform->worldX + playerCollision->offsetX;
     float playerY = playerTransform->worldY + playerCollision->offsetY;
     float playerWidth = playerCollision->boxWidth;
     float playerHeight = playerCollision->boxHeight;
 
-    // Get only nearby entities from spatial grid (O(1) lookup instead of O(n))
-    std::vector<Entity*> nearby = m_spatialGrid.GetNearbyEntities(player);
-    
-    for (auto* entity : nearby)
+    // Get only nearby entities from spatial grid (O(1) lookup instead of O(n)), into a
+    // buffer kept across frames so the query allocates nothing once it has grown
+    if (m_gridBackend == GridBackend::Flat)
+        m_flatGrid.GetNearbyEntities(player, m_nearby);
+    else
+        m_spatialGrid.GetNearbyEntities(player, m_nearby);
+
+    // Broad-phase: AABB overlap tests on the cached boxes, a batch at a time
+    ColliderBox playerBox = { playerX, playerY, playerX + playerWidth, playerY + playerHeight };
+    GatherCandidates(m_nearby);
+    m_lastBroadPhaseChecks = (int)m_nearby.size();
+    m_hits.clear();
+    m_candidates.ForEachOverlap(playerBox, 0, m_candidates.GetCount(), [this](uint32_t _index)
+    {
+        m_hits.push_back(_index);
+    });
+
+    for (uint32_t hit : m_hits)
     {
-        if (!entity || !entity->IsActive() || entity == player) continue;
-        auto* entityTransform = entity->GetComponent<TransformComponent>();
-        auto* entityCollision = entity->GetComponent<CollisionComponent>();
-        if (!entityTransform || !entityCollision) continue;
-
-        float entityX = entityTransform->worldX + entityCollision->offsetX;
-        float entityY = entityTransform->worldY + entityCollision->offsetY;
-        float entityWidth = entityCollision->boxWidth;
-        float entityHeight = entityCollision->boxHeight;
-
-        // Broad-phase: AABB overlap test
-        m_lastBroadPhaseChecks++;
-        bool overlapping = SpatialGrid::AABBOverlap(
-            playerX, playerY, playerWidth, playerHeight,
-            entityX, entityY, entityWidth, entityHeight);
-        
-        if (!overlapping) continue;
-        
+        // Skip what an earlier hit this frame already took out
+        Entity* entity = m_nearby[hit];
+        if (!entity->IsActive() || entity == player) continue;
+        float entityY = m_candidates.Get(hit).minY;
+
         // Narrow-phase: detailed collision handling
         m_lastNarrowPhaseChecks++;
 
@@ -459,11 +474,11 @@ void EntityCollisionSystem::Update(std::vector<Entity*>& _entities, float _delta
         {
             collectible->collected = true;
             entity->SetActive(false);
-            m_spatialGrid.Remove(entity);
-            m_score += collectible->pointValue;
-            
-            // Play collect sound for collectible pickup
-            GameAudioManager::Instance().PlayClickSound();
+
+            // Out of the static layer now, so later queries in its cells do not skip over it
+            if (m_gridBackend == GridBackend::Hashed && IsStaticCollider(entity->GetArchetype()))
+                m_spatialGrid.RemoveStatic(entity);
+            _manager.GetEvents().Emit(GameEventType::CoinCollected, entity->GetID(), collectible->pointValue);
             continue;
         }
 
@@ -475,12 +490,8 @@ void EntityCollisionSystem::Update(std::vector<Entity*>& _entities, float _delta
             {
                 enemy->destroyed = true;
                 entity->SetActive(false);
-                m_spatialGrid.Remove(entity);
-                m_score += 50;
-                
-                // Play enemy stomp sound
-                GameAudioManager::Instance().PlayEnemyStompSound();
-                
+                _manager.GetEvents().Emit(GameEventType::EnemyStomped, entity->GetID(), 50);
+
                 if (playerMovement)
                 {
                     auto* jump = player->GetComponent<JumpComponent>();
@@ -500,11 +511,10 @@ void EntityCollisionSystem::Update(std::vector<Entity*>& _entities, float _delta
                 {
                     playerHealth->health = 0;
                     playerHealth->isDead = true;
-                    playerHealth->deathTimer = 0;
-                    
-                    // Play player death sound
-                    GameAudioManager::Instance().PlayDieSound();
-                    
+                    _manager.GetTimers().Start(playerHealth->deathEnd, player->GetID(), TimerKind::DeathEnd, playerHealth->deathDuration);
+
+                    _manager.GetEvents().Emit(GameEventType::PlayerDied, player->GetID());
+
                     if (playerMovement)
                     {
                         playerMovement->velocityX = 0;
@@ -513,11 +523,10 @@ void EntityCollisionSystem::Update(std::vector<Entity*>& _entities, float _delta
                 }
                 else
                 {
-                    // Player hurt - play hurt sound
-                    GameAudioManager::Instance().PlayHurtSound();
-                    
+                    _manager.GetEvents().Emit(GameEventType::PlayerHurt, player->GetID());
+
                     playerHealth->isInvincible = true;
-                    playerHealth->invincibleTimer = playerHealth->invincibleDuration;
+                    _manager.GetTimers().Start(playerHealth->invincibleEnd, player->GetID(), TimerKind::InvincibilityEnd, playerHealth->invincibleDuration);
                 }
             }
         }
@@ -525,90 +534,295 @@ void EntityCollisionSystem::Update(std::vector<Entity*>& _entities, float _delta
 }
 
 EntityCollisionSystem::EntityCollisionSystem(int _cellSize)
-    : m_spatialGrid(_cellSize)
+    : m_spatialGrid(_cellSize), m_flatGrid(_cellSize)
+{
+    Require<PlayerTag, TransformComponent, CollisionComponent>();
+    Reads<PlayerTag, TransformComponent, CollisionComponent>();
+    Writes<CollectibleComponent, EnemyComponent, HealthComponent, MovementComponent, JumpComponent, PhysicsComponent>();
+    WritesResource(RESOURCE_ACTIVE_STATE);
+}
+
+void EntityCollisionSystem::Initialize(ArchetypeStorage& _storage)
+{
+    System::Initialize(_storage);
+    m_colliderArchetypes = &_storage.GetQuery(MakeSignature<CollisionComponent>());
+}
+
+constexpr size_t EntityCollisionSystem::COLLIDER_TYPES;
+
+void EntityCollisionSystem::SetPairHandler(ColliderType _a, ColliderType _b, PairHandler _handler)
+{
+    size_t a = static_cast<size_t>(_a);
+    size_t b = static_cast<size_t>(_b);
+    if (a != b)
+    {
+        // Same handler for pairs found the other way round, arguments swapped back
+        m_pairHandlers[b * COLLIDER_TYPES + a] = [_handler](Entity* _first, Entity* _second) { _handler(_second, _first); };
+    }
+    m_pairHandlers[a * COLLIDER_TYPES + b] = std::move(_handler);
+
+    m_hasPairHandlers = false;
+    for (const PairHandler& handler : m_pairHandlers)
+        if (handler) m_hasPairHandlers = true;
+}
+
+void EntityCollisionSystem::ResolvePairs()
 {
+    for (const CollisionPair& pair : m_sweep.GetPairs())
+    {
+        // An earlier handler may have taken either one out
+        if (!pair.a->IsActive() || !pair.b->IsActive()) continue;
+
+        auto* collisionA = pair.a->GetComponent<CollisionComponent>();
+        auto* collisionB = pair.b->GetComponent<CollisionComponent>();
+        size_t a = static_cast<size_t>(collisionA->type);
+        size_t b = static_cast<size_t>(collisionB->type);
+
+        const PairHandler& handler = m_pairHandlers[a * COLLIDER_TYPES + b];
+        if (handler) handler(pair.a, pair.b);
+    }
+}
+
+void EntityCollisionSystem::GatherCandidates(const std::vector<Entity*>& _entities)
+{
+    m_candidates.Resize((uint32_t)_entities.size());
+    for (uint32_t i = 0; i < _entities.size(); ++i)
+    {
+        uint32_t slot = m_colliders.Find(_entities[i]);
+        m_candidates.Set(i, slot != ColliderCache::NONE ? m_colliders.GetBox(slot) : ColliderBoxes::EMPTY_BOX);
+    }
+}
+
+void EntityCollisionSystem::GetCollidersInRegion(float _x, float _y, float _width, float _height, std::vector<Entity*>& _out)
+{
+    // The grid narrows the search to the region's cells, the kernel keeps exact overlaps
+    if (m_gridBackend == GridBackend::Flat)
+        m_flatGrid.GetEntitiesInRegion(_x, _y, _width, _height, m_regionNearby);
+    else
+        m_spatialGrid.GetEntitiesInRegion(_x, _y, _width, _height, m_regionNearby);
+
+    _out.clear();
+    GatherCandidates(m_regionNearby);
+    ColliderBox region = { _x, _y, _x + _width, _y + _height };
+    m_candidates.ForEachOverlap(region, 0, m_candidates.GetCount(), [this, &_out](uint32_t _index)
+    {
+        _out.push_back(m_regionNearby[_index]);
+    });
 }
 
-void EntityCollisionSystem::RebuildGrid(std::vector<Entity*>& _entities)
+void EntityCollisionSystem::SetGridBackend(GridBackend _backend)
 {
+    m_gridBackend = _backend;
+    m_gridBuilt = false;
     m_spatialGrid.Clear();
-    for (auto* entity : _entities)
+    m_flatGrid.Clear();
+}
+
+void EntityCollisionSystem::CollectColliders(bool _dynamicOnly)
+{
+    m_gridEntities.clear();
+    for (Archetype* archetype : *m_colliderArchetypes)
     {
-        if (entity && entity->IsActive() && entity->HasComponent<CollisionComponent>())
+        if (_dynamicOnly && IsStaticCollider(archetype)) continue;
+        for (uint32_t i = 0; i < archetype->GetActiveCount(); ++i)
         {
-            m_spatialGrid.Insert(entity);
+            Entity* entity = archetype->GetEntity(i);
+            if (entity->IsActive()) m_gridEntities.push_back(entity);  // Not deactivated this tick
         }
     }
 }
 
+void EntityCollisionSystem::RebuildGrid(EntityManager& _manager)
+{
+    if (m_gridBackend == GridBackend::Flat)
+    {
+        CollectColliders(false);
+        m_flatGrid.Rebuild(m_gridEntities);
+        return;
+    }
+
+    // The static layer is only updated as coins change, and waking is not a change,
+    // so dormant coins go in as well; queries skip them until they wake. Collected
+    // ones stay out, as if they had been removed at collection.
+    m_spatialGrid.Clear();
+    for (Archetype* archetype : *m_colliderArchetypes)
+    {
+        if (!IsStaticCollider(archetype)) continue;
+        auto* collectibles = archetype->GetColumn<CollectibleComponent>();
+        for (uint32_t i = 0; i < archetype->GetCount(); ++i)
+        {
+            const CollectibleComponent* collectible = RowOrNull(collectibles, i);
+            if (!collectible || !collectible->collected) m_spatialGrid.InsertStatic(archetype->GetEntity(i));
+        }
+    }
+
+    CollectColliders(true);
+    m_spatialGrid.Rebuild(m_gridEntities);
+}
+
+void EntityCollisionSystem::OnEntityRemoved(Entity* _entity)
+{
+    m_spatialGrid.RemoveStatic(_entity);
+}
+
+void EntityCollisionSystem::UpdateGrid(EntityManager& _manager)
+{
+    ArchetypeStorage& storage = _manager.GetStorage();
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    if (m_gridBackend == GridBackend::Flat || !m_gridBuilt)
+    {
+        RebuildGrid(_manager);
+        m_gridBuilt = true;
+    }
+    else
+    {
+        // Static layer: only coins spawned or repositioned since the last frame. Collected
+        // ones were taken out on collection and are not filed again, destroyed ones by
+        // OnEntityRemoved.
+        _manager.View<const TransformComponent, const CollisionComponent>().EachChanged(m_gridTick,
+            [this](Entity* _entity, const TransformComponent&, const CollisionComponent&)
+            {
+                if (!IsStaticCollider(_entity->GetArchetype())) return;
+                auto* collectible = _entity->GetComponent<CollectibleComponent>();
+                if (collectible && collectible->collected) m_spatialGrid.RemoveStatic(_entity);
+                else m_spatialGrid.UpdateStatic(_entity);
+            });
+
+        // Dynamic layer: everything that can move, every frame
+        CollectColliders(true);
+        m_spatialGrid.Rebuild(m_gridEntities);
+    }
+
+    m_gridTick = storage.GetTick();
+    m_lastGridTime = (float)(SDL_GetPerformanceCounter() - start) * 1000.0f / SDL_GetPerformanceFrequency();
+}
+
 void EntityCollisionSystem::UpdateEntityInGrid(Entity* _entity)
 {
-    m_spatialGrid.Update(_entity);
+    // The flat grid picks the move up at its next rebuild
+    if (m_gridBackend == GridBackend::Hashed) m_spatialGrid.Update(_entity);
 }
 
 void EntityCollisionSystem::RenderDebug(Renderer* _renderer, Camera* _camera, float _viewportWidth, float _viewportHeight)
 {
-    if (m_debugDrawEnabled)
-    {
+    if (!m_debugDrawEnabled) return;
+
+    if (m_gridBackend == GridBackend::Flat)
+        m_flatGrid.RenderDebug(_renderer, _camera, _viewportWidth, _viewportHeight);
+    else
         m_spatialGrid.RenderDebug(_renderer, _camera, _viewportWidth, _viewportHeight);
-    }
 }
 
-void AnimationSystem::Update(std::vector<Entity*>& _entities, float _deltaTime)
+// Move the clip cursor on by _seconds, looping at the end of the clip
+static void AdvanceClip(SpriteComponent& _sprite, float _seconds)
 {
-    for (auto* entity : _entities)
+    if (!_sprite.animSet) return;
+    const AnimationClip& clip = _sprite.animSet->GetClip(_sprite.clip);
+    if (clip.frameCount <= 0) return;
+    _sprite.clipTime = fmod(_sprite.clipTime + clip.frameRate * _seconds, (float)clip.frameCount);
+}
+
+void AnimationSystem::AdvanceClips(EntityManager& _manager, float _deltaTime)
+{
+    const SimLod& lod = _manager.GetSimLod();
+    if (!lod.enabled)
     {
-        if (!entity || !entity->IsActive()) continue;
-        auto* sprite = entity->GetComponent<SpriteComponent>();
-        auto* movement = entity->GetComponent<MovementComponent>();
-        auto* physics = entity->GetComponent<PhysicsComponent>();
-        auto* health = entity->GetComponent<HealthComponent>();
-        auto* punch = entity->GetComponent<PunchComponent>();
-        if (!sprite) continue;
+        _manager.ParallelEach<SpriteComponent>([&lod, _deltaTime](SpriteComponent& _sprite)
+        {
+            AdvanceClip(_sprite, _deltaTime);
+            _sprite.lastUpdateTime = lod.time;
+        });
+        return;
+    }
 
-        if (movement)
+    // Off-screen sprites advance less often, staggered by entity index like PatrolStep,
+    // and Far ones not at all. Each update covers the whole time since the last one,
+    // so a clip is at the frame it would have reached when it comes into view.
+    bool cull = m_cullOffscreen;
+    _manager.ParallelEachWithEntity<SpriteComponent, const TransformComponent>(
+        [&lod, cull, _deltaTime](Entity* _entity, SpriteComponent& _sprite, const TransformComponent& _transform)
         {
-            if (movement->velocityX > 0) sprite->facingRight = true;
-            else if (movement->velocityX < 0) sprite->facingRight = false;
-        }
+            SimLodTier tier = lod.TierOf(_transform.worldX, _transform.worldX + _transform.width * _transform.scale);
+            if (cull && tier != SimLodTier::Full) return;
+            if (!lod.IsDue(tier, GetEntityIndex(_entity->GetID()))) return;
+
+            float elapsed = _sprite.lastUpdateTime < 0 ? _deltaTime : (float)(lod.time - _sprite.lastUpdateTime);
+            _sprite.lastUpdateTime = lod.time;
+            AdvanceClip(_sprite, elapsed);
+        });
+}
+
+void AnimationSystem::Update(EntityManager& _manager, float _deltaTime)
+{
+    AdvanceClips(_manager, _deltaTime);
 
-        if (entity->HasComponent<PlayerTag>() && health)
+    // Face the direction of travel, keep the old facing when standing still
+    _manager.ParallelEach<SpriteComponent, const MovementComponent>(
+        [](SpriteComponent& _sprite, const MovementComponent& _movement)
         {
-            sprite->flickering = health->isInvincible;
-            if (health->isDead) sprite->currentAnimation = "hurt";
-            else if (punch && punch->isPunching) sprite->currentAnimation = "punch";
-            else if (physics && !physics->isGrounded) sprite->currentAnimation = "jumpandfall";
-            else if (movement && movement->velocityX != 0) sprite->currentAnimation = "run";
-            else sprite->currentAnimation = "idle";
-        }
-    }
+            _sprite.facingRight = _movement.velocityX > 0 || (_sprite.facingRight && _movement.velocityX >= 0);
+        });
+
+    // Player animation state, a new clip starts from its first frame
+    _manager.Each<const PlayerTag, SpriteComponent, const HealthComponent, const PhysicsComponent,
+                  const MovementComponent, const PunchComponent>(
+        [](const PlayerTag&, SpriteComponent& _sprite, const HealthComponent& _health, const PhysicsComponent& _physics,
+           const MovementComponent& _movement, const PunchComponent& _punch)
+        {
+            _sprite.flickering = _health.isInvincible;
+            AnimClip clip = _health.isDead ? AnimClip::Hurt
+                : _punch.isPunching ? AnimClip::Punch
+                : !_physics.isGrounded ? AnimClip::JumpAndFall
+                : _movement.velocityX != 0 ? AnimClip::Run
+                : AnimClip::Idle;
+            _sprite.clipTime = clip == _sprite.clip ? _sprite.clipTime : 0.0f;
+            _sprite.clip = clip;
+        });
 }
 
-void RenderSystem::Render(std::vector<Entity*>& _entities, Renderer* _renderer, Camera* _camera)
+void RenderSystem::Extract(float _cameraX, float _viewWidth, float _alpha, vector<SpriteInstance>& _out)
 {
-    for (auto* entity : _entities)
+    for (Archetype* archetype : *m_archetypes)
     {
-        if (!entity || !entity->IsActive()) continue;
-        auto* transform = entity->GetComponent<TransformComponent>();
-        auto* sprite = entity->GetComponent<SpriteComponent>();
-        if (!transform || !sprite || !sprite->visible || !sprite->animLoader) continue;
+        auto* transforms = archetype->GetColumn<TransformComponent>();
+        auto* sprites = archetype->GetColumn<SpriteComponent>();
+
+        for (uint32_t i = 0; i < archetype->GetActiveCount(); ++i)
+        {
+            if (!archetype->GetEntity(i)->IsActive()) continue;  // Deactivated since the last partition
+            auto* transform = transforms->Get(i);
+            auto* sprite = sprites->Get(i);
+            if (!sprite->visible || !sprite->animSet) continue;
 
-        if (sprite->flickering && ++sprite->flickerCounter % 6 < 3) continue;
+            if (sprite->flickering && ++sprite->flickerCounter % 6 < 3) continue;
 
-        float width = transform->width * transform->scale;
-        float height = transform->height * transform->scale;
-        float screenX = _camera ? _camera->WorldToScreenX(transform->worldX) : transform->worldX;
-        float screenY = transform->worldY;
+            float width = transform->width * transform->scale;
+            float height = transform->height * transform->scale;
+            float screenX = InterpolatedX(*transform, _alpha) - _cameraX;
+            float screenY = InterpolatedY(*transform, _alpha);
 
-        Point windowSize = _renderer->GetWindowSize();
-        if (screenX < -width || screenX > windowSize.X + width || screenY + height < 0) continue;
+            if (screenX < -width || screenX > _viewWidth + width || screenY + height < 0) continue;
 
-        Rect destRect = sprite->facingRight
-            ? Rect((unsigned)screenX, (unsigned)(screenY < 0 ? 0 : screenY), (unsigned)(screenX + width), (unsigned)(screenY + height))
-            : Rect((unsigned)(screenX + width), (unsigned)(screenY < 0 ? 0 : screenY), (unsigned)screenX, (unsigned)(screenY + height));
+            Rect destRect = sprite->facingRight
+                ? Rect((unsigned)screenX, (unsigned)(screenY < 0 ? 0 : screenY), (unsigned)(screenX + width), (unsigned)(screenY + height))
+                : Rect((unsigned)(screenX + width), (unsigned)(screenY < 0 ? 0 : screenY), (unsigned)screenX, (unsigned)(screenY + height));
 
-        Rect srcRect = sprite->animLoader->UpdateAnimation(sprite->currentAnimation, Timing::Instance().GetDeltaTime());
-        Texture* texture = sprite->animLoader->GetTexture(sprite->currentAnimation);
-        if (texture) _renderer->RenderTexture(texture, srcRect, destRect);
+            // AnimationSystem moves the cursor; the frame shown is wherever the last tick left it
+            const AnimationClip& clip = sprite->animSet->GetClip(sprite->clip);
+            Rect srcRect = clip.GetFrameRect(sprite->clipTime);
+            if (clip.texture) _out.push_back({ clip.texture, srcRect, destRect });
+        }
     }
 }
+
+void RenderSystem::Draw(Renderer* _renderer, const vector<SpriteInstance>& _sprites)
+{
+    for (const SpriteInstance& sprite : _sprites)
+        _renderer->RenderTexture(sprite.texture, sprite.src, sprite.dest);
+}
+
+// The step bodies above are inlined into these passes' loops
+template class FusedPass<PhysicsStep, JumpStep, DashStep>;
+template class FusedPass<MovementStep>;
+template class FusedPass<PatrolStep>;
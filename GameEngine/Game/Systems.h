@@ -4,107 +4,281 @@
 #include "Entity.h"
 #include "Components.h"
 #include "SpatialGrid.h"
+#include "FlatSpatialGrid.h"
+#include "SweepAndPrune.h"
+#include "ColliderCache.h"
+#include "RenderSnapshot.h"
+#include <array>
+#include <functional>
 #include <vector>
 
 class Renderer;
 class Camera;
 class ChunkMap;
+class EntityManager;
 
 /**
  * Systems contain all game logic.
  * 
  * Each system operates on entities that have specific components.
- * Ex: MovementSystem updates entities with Transform + Movement components.
+ * Ex: PunchSystem updates the player's PunchComponent.
+ *
+ * Systems walk the component columns of every matching archetype
+ * instead of looking components up entity by entity. Each system declares
+ * the components it requires once; the list of archetypes holding them is
+ * cached by ArchetypeStorage and only grows when a new archetype appears.
+ *
+ * Systems also declare which components they read and write, plus shared
+ * non-component state (SystemResource). SystemScheduler runs systems whose
+ * declarations do not conflict at the same time. A system limited to some
+ * entities (OnlyWith/OnlyWithout) does not conflict over components with one
+ * whose entities it can never share, e.g. player-only work and enemy patrol.
  */
 
+// Shared state outside component columns that systems touch
+enum SystemResource : uint32_t
+{
+    RESOURCE_INPUT = 1 << 0,         // Keyboard/mouse state
+    RESOURCE_ACTIVE_STATE = 1 << 1   // Entity::IsActive/SetActive
+};
+
+// Declared data access of one system
+struct SystemAccess
+{
+    ComponentSignature reads;
+    ComponentSignature writes;
+    uint32_t resourceReads = 0;
+    uint32_t resourceWrites = 0;
+
+    // Entities the component access is limited to: each has every component in
+    // with and none in without. Both empty means any entity.
+    ComponentSignature with;
+    ComponentSignature without;
+
+    // True if no entity can pass both filters, so shared component types are never the same rows
+    bool DisjointFrom(const SystemAccess& _other) const
+    {
+        return (with & _other.without).any() || (_other.with & without).any();
+    }
+
+    // True if running both systems at once could race
+    bool ConflictsWith(const SystemAccess& _other) const
+    {
+        bool components = (writes & (_other.reads | _other.writes)).any()
+                       || (_other.writes & reads).any();
+        return (components && !DisjointFrom(_other))
+            || (resourceWrites & (_other.resourceReads | _other.resourceWrites)) != 0
+            || (_other.resourceWrites & resourceReads) != 0;
+    }
+};
+
 class System
 {
 public:
     virtual ~System() = default;
-    virtual void Update(std::vector<Entity*>& _entities, float _deltaTime) {}
-    virtual void Render(std::vector<Entity*>& _entities, Renderer* _renderer, Camera* _camera) {}
+
+    // Bind cached archetype lists, called once by EntityManager
+    virtual void Initialize(ArchetypeStorage& _storage) { m_archetypes = &_storage.GetQuery(m_signature); }
+
+    virtual void Update(EntityManager& _manager, float _deltaTime) {}
+    virtual void Render(EntityManager& _manager, Renderer* _renderer, Camera* _camera) {}
+
+    const ComponentSignature& GetSignature() const { return m_signature; }
+    const SystemAccess& GetAccess() const { return m_access; }
+
+protected:
+    // Declare the components an archetype must store for this system to visit it
+    template<typename... Ts>
+    void Require() { m_signature = MakeSignature<Ts...>(); }
+
+    // Declare component and resource access for the scheduler
+    template<typename... Ts>
+    void Reads() { m_access.reads |= MakeSignature<Ts...>(); }
+    template<typename... Ts>
+    void Writes() { m_access.writes |= MakeSignature<Ts...>(); }
+    // Declare that every entity whose components the system touches has all of Ts, or
+    // none of Ts; the system itself must skip the rest
+    template<typename... Ts>
+    void OnlyWith() { m_access.with |= MakeSignature<Ts...>(); }
+    template<typename... Ts>
+    void OnlyWithout() { m_access.without |= MakeSignature<Ts...>(); }
+    void ReadsResource(uint32_t _resources) { m_access.resourceReads |= _resources; }
+    void WritesResource(uint32_t _resources) { m_access.resourceWrites |= _resources; }
+
+    ComponentSignature m_signature;
+    SystemAccess m_access;
+    const std::vector<Archetype*>* m_archetypes = nullptr;
 };
 
 // Reads keyboard input and sets player velocity
 class InputSystem : public System
 {
 public:
-    void Update(std::vector<Entity*>& _entities, float _deltaTime) override;
+    InputSystem()
+    {
+        Require<InputComponent, MovementComponent>();
+        Reads<InputComponent>();
+        Writes<MovementComponent, SpriteComponent, JumpComponent, DashComponent, PunchComponent>();
+        ReadsResource(RESOURCE_INPUT | RESOURCE_ACTIVE_STATE);
+    }
+    void Update(EntityManager& _manager, float _deltaTime) override;
+};
+
+/**
+ * Per-entity kernels run by a FusedPass (see FusedPass.h). Several steps share
+ * one traversal, so an entity's components are loaded once for all of them.
+ */
+
+// Per-frame values every step receives
+struct StepContext
+{
+    EntityManager* manager;
+    float deltaTime;
+};
+
+// How often an entity's AI is updated, by its distance from the view
+enum class SimLodTier : uint8_t
+{
+    Full,       // On screen (plus a margin): every tick
+    Half,       // Within half a screen: every 2nd tick
+    Quarter,    // Within a screen: every 4th tick
+    Far         // Further: not updated, caught up in one step once it is nearer
+};
+
+// Simulation level of detail, set by EntityManager each tick and read by systems
+struct SimLod
+{
+    bool enabled = false;           // Off (no view yet): everything is Full
+    float viewLeft = 0, viewRight = 0;
+    uint32_t tick = 0;
+    double time = 0;                // Simulated seconds, including this tick
+
+    SimLodTier TierOf(float _left, float _right) const;
+
+    // Whether an entity in _tier updates this tick; _phase spreads entities over ticks
+    bool IsDue(SimLodTier _tier, uint32_t _phase) const;
+};
+
+// Base for FusedPass steps; hides DeclareAccess to declare non-component access
+// and Excludes to skip entities that have any of the listed components
+struct FusedStep
+{
+    using Excludes = ComponentList<>;
+    static void DeclareAccess(SystemAccess&) {}
 };
 
 // Applies gravity to entities with PhysicsComponent
-class PhysicsSystem : public System
+struct PhysicsStep : FusedStep
 {
-public:
-    void Update(std::vector<Entity*>& _entities, float _deltaTime) override;
+    using Components = ComponentList<MovementComponent, const PhysicsComponent>;
+    void Run(const StepContext& _context, Entity* _entity, MovementComponent& _movement, const PhysicsComponent& _physics) const;
 };
 
 // Handles jump input, coyote time, and variable jump height
-class JumpSystem : public System
+struct JumpStep : FusedStep
 {
-public:
-    void Update(std::vector<Entity*>& _entities, float _deltaTime) override;
+    using Components = ComponentList<MovementComponent, PhysicsComponent, JumpComponent>;
+    void Run(const StepContext& _context, Entity* _entity, MovementComponent& _movement, PhysicsComponent& _physics, JumpComponent& _jump) const;
 };
 
 // Handles dash ability triggered by shift key
-class DashSystem : public System
+struct DashStep : FusedStep
 {
-public:
-    void Update(std::vector<Entity*>& _entities, float _deltaTime) override;
+    using Components = ComponentList<MovementComponent, DashComponent>;
+    static void DeclareAccess(SystemAccess& _access) { _access.reads.set(ComponentTypeID<SpriteComponent>::value); }
+    void Run(const StepContext& _context, Entity* _entity, MovementComponent& _movement, DashComponent& _dash) const;
 };
 
 // Handles punch attack - kills enemies in front of player
 class PunchSystem : public System
 {
 public:
-    void Update(std::vector<Entity*>& _entities, float _deltaTime) override;
+    PunchSystem()
+    {
+        Require<PlayerTag, TransformComponent, PunchComponent>();
+        Reads<PlayerTag, TransformComponent, SpriteComponent>();
+        Writes<PunchComponent, MovementComponent, EnemyComponent>();
+        WritesResource(RESOURCE_ACTIVE_STATE);
+    }
+    void Initialize(ArchetypeStorage& _storage) override;
+    void Update(EntityManager& _manager, float _deltaTime) override;
+private:
+    const std::vector<Archetype*>* m_enemyArchetypes = nullptr;
 };
 
 // Applies velocity to position
-class MovementSystem : public System
+struct MovementStep : FusedStep
 {
-public:
-    void Update(std::vector<Entity*>& _entities, float _deltaTime) override;
+    using Components = ComponentList<TransformComponent, const MovementComponent>;
+    void Run(const StepContext& _context, Entity* _entity, TransformComponent& _transform, const MovementComponent& _movement) const;
 };
 
 // Handles collision between player and world tiles
 class CollisionSystem : public System
 {
 public:
+    CollisionSystem()
+    {
+        Require<PlayerTag, CollisionComponent>();
+        OnlyWith<PlayerTag>();
+        Reads<CollisionComponent>();
+        Writes<TransformComponent, MovementComponent, PhysicsComponent, JumpComponent>();
+        ReadsResource(RESOURCE_ACTIVE_STATE);
+    }
     void SetChunkMap(ChunkMap* _map) { m_chunkMap = _map; }
-    void Update(std::vector<Entity*>& _entities, float _deltaTime) override;
+    void Update(EntityManager& _manager, float _deltaTime) override;
 private:
     void HandlePlayerCollision(Entity* _entity);
     ChunkMap* m_chunkMap = nullptr;
 };
 
-// Moves enemies back and forth within patrol boundaries
-class PatrolSystem : public System
+// Moves enemies back and forth within patrol boundaries. Off-screen enemies
+// patrol less often (SimLod) and are moved by the whole time since their last
+// update, so they are where they would have been when the player arrives.
+struct PatrolStep : FusedStep
 {
-public:
+    using Components = ComponentList<TransformComponent, MovementComponent, PatrolComponent>;
+    using Excludes = ComponentList<PlayerTag>;     // Keeps it off the player, so it runs beside player-only systems
     void SetMapWidth(int _width) { m_mapWidth = _width; }
-    void Update(std::vector<Entity*>& _entities, float _deltaTime) override;
+    void Run(const StepContext& _context, Entity* _entity, TransformComponent& _transform, MovementComponent& _movement, PatrolComponent& _patrol) const;
 private:
     int m_mapWidth = 0;
 };
 
+template<typename... Steps>
+class FusedPass;
+
+// Everything that only touches the entity it visits, fused in update order.
+// PatrolPass is its own pass: it never touches the player, so the scheduler
+// runs it at the same time as CollisionSystem, which only moves the player.
+using PhysicsPass = FusedPass<PhysicsStep, JumpStep, DashStep>;
+using MovementPass = FusedPass<MovementStep>;
+using PatrolPass = FusedPass<PatrolStep>;
+
 // Repositions entities for infinite scrolling
 class ScrollSystem : public System
 {
 public:
+    ScrollSystem()
+    {
+        Require<TransformComponent, ScrollableComponent>();
+        Reads<ScrollableComponent>();
+        Writes<TransformComponent, MovementComponent>();
+        WritesResource(RESOURCE_ACTIVE_STATE);
+    }
     void SetParams(float _cameraX, int _screenWidth, int _mapWidth);
-    void Update(std::vector<Entity*>& _entities, float _deltaTime) override;
+    void Update(EntityManager& _manager, float _deltaTime) override;
 private:
     float m_cameraX = 0;
     int m_screenWidth = 0;
     int m_mapWidth = 0;
 };
 
-// Updates invincibility timer and death state
-class HealthSystem : public System
+// Which grid EntityCollisionSystem keeps colliders in
+enum class GridBackend
 {
-public:
-    void Update(std::vector<Entity*>& _entities, float _deltaTime) override;
+    Hashed,     // SpatialGrid: hash map of cells, only moved colliders re-inserted
+    Flat        // FlatSpatialGrid: flat arrays over the awake window, rebuilt every frame
 };
 
 // Handles player vs enemy/coin collisions using spatial partitioning
@@ -113,20 +287,45 @@ class EntityCollisionSystem : public System
 {
 public:
     EntityCollisionSystem(int _cellSize = 64);
+    void Initialize(ArchetypeStorage& _storage) override;
+
+    // Switch grids at runtime to compare them; the new one is built on the next update
+    void SetGridBackend(GridBackend _backend);
+    GridBackend GetGridBackend() const { return m_gridBackend; }
+
+    // World x range of the awake chunks, the columns of the flat grid
+    void SetGridWindow(float _left, float _right) { m_flatGrid.SetWindow(_left, _right); }
     
     // Rebuild spatial grid with all entities (call when entities added/removed)
-    void RebuildGrid(std::vector<Entity*>& _entities);
+    void RebuildGrid(EntityManager& _manager);
+
+    // Hashed grid: refile static colliders whose Transform/Collision changed since
+    // the last call and rebuild the dynamic layer. Flat grid: RebuildGrid every call.
+    void UpdateGrid(EntityManager& _manager);
+
+    // Drop a destroyed entity from the static layer
+    void OnEntityRemoved(Entity* _entity);
     
     // Update entity position in grid (call after movement)
     void UpdateEntityInGrid(Entity* _entity);
     
-    void Update(std::vector<Entity*>& _entities, float _deltaTime) override;
-    int GetScore() const { return m_score; }
-    void ResetScore() { m_score = 0; }
+    void Update(EntityManager& _manager, float _deltaTime) override;
+
+    // Narrow phase between moving colliders: _handler(a, b) is called for each pair the
+    // sweep finds where a is of type _a and b of type _b. Pairs without a handler are ignored,
+    // and with no handlers at all the sweep does not run. Pass nullptr to remove one.
+    using PairHandler = std::function<void(Entity*, Entity*)>;
+    void SetPairHandler(ColliderType _a, ColliderType _b, PairHandler _handler);
+
+    // Active colliders whose boxes overlap a world region (not just share a grid cell), as of
+    // the last update; _out is cleared first
+    void GetCollidersInRegion(float _x, float _y, float _width, float _height, std::vector<Entity*>& _out);
     
     // Stats for debugging
     int GetLastBroadPhaseChecks() const { return m_lastBroadPhaseChecks; }
     int GetLastNarrowPhaseChecks() const { return m_lastNarrowPhaseChecks; }
+    float GetLastGridTime() const { return m_lastGridTime; }   // Milliseconds spent updating the grid
+    int GetLastPairCount() const { return (int)m_sweep.GetPairs().size(); }
     
     // Debug visualization
     void ToggleDebugDraw() { m_debugDrawEnabled = !m_debugDrawEnabled; }
@@ -134,25 +333,73 @@ public:
     void RenderDebug(Renderer* _renderer, Camera* _camera, float _viewportWidth, float _viewportHeight);
     
 private:
+    static constexpr size_t COLLIDER_TYPES = static_cast<size_t>(ColliderType::Count);
+
+    void CollectColliders(bool _dynamicOnly);
+    void ResolvePairs();
+
+    // Cached boxes of _entities into m_candidates, in the same order
+    void GatherCandidates(const std::vector<Entity*>& _entities);
+
     SpatialGrid m_spatialGrid;
-    int m_score = 0;
+    FlatSpatialGrid m_flatGrid;
+    GridBackend m_gridBackend = GridBackend::Hashed;
+    const std::vector<Archetype*>* m_colliderArchetypes = nullptr;
+    std::vector<Entity*> m_gridEntities;   // Scratch for RebuildGrid
+    std::vector<Entity*> m_nearby;         // Query results, reused every frame
+    ColliderCache m_colliders;              // Every active collider's box, refreshed each update
+    ColliderBoxes m_candidates;             // Boxes of grid query results, for the overlap kernel
+    std::vector<uint32_t> m_hits;           // Indices into m_nearby that overlap the player
+    std::vector<Entity*> m_regionNearby;    // Grid results for GetCollidersInRegion
+    SweepAndPrune m_sweep;                  // Moving colliders against each other
+    std::array<PairHandler, COLLIDER_TYPES * COLLIDER_TYPES> m_pairHandlers;
+    bool m_hasPairHandlers = false;
+    uint32_t m_gridTick = 0;                // Storage tick the grid is up to date with
+    bool m_gridBuilt = false;
     int m_lastBroadPhaseChecks = 0;
     int m_lastNarrowPhaseChecks = 0;
+    float m_lastGridTime = 0;
     bool m_debugDrawEnabled = false;
 };
 
-// Updates sprite animation based on entity state
+// Advances sprite animation (at SimLod rates off screen) and picks clips from entity state
 class AnimationSystem : public System
 {
 public:
-    void Update(std::vector<Entity*>& _entities, float _deltaTime) override;
+    AnimationSystem()
+    {
+        Require<SpriteComponent>();
+        Reads<PlayerTag, TransformComponent, MovementComponent, PhysicsComponent, HealthComponent, PunchComponent>();
+        Writes<SpriteComponent>();
+    }
+    // Skip every entity outside the view instead of updating them at SimLod rates
+    void SetCullOffscreen(bool _cull) { m_cullOffscreen = _cull; }
+    void Update(EntityManager& _manager, float _deltaTime) override;
+
+    // Only move the clip cursors on, for frames without a simulation tick
+    void AdvanceClips(EntityManager& _manager, float _deltaTime);
+private:
+    bool m_cullOffscreen = false;
 };
 
-// Renders all visible sprites
+// Collects visible sprites for drawing
 class RenderSystem : public System
 {
 public:
-    void Render(std::vector<Entity*>& _entities, Renderer* _renderer, Camera* _camera) override;
+    RenderSystem()
+    {
+        Require<TransformComponent, SpriteComponent>();
+        Reads<TransformComponent>();
+        Writes<SpriteComponent>();
+        ReadsResource(RESOURCE_ACTIVE_STATE);
+    }
+
+    // Append the sprites visible from _cameraX to _out, positioned _alpha (0..1)
+    // of the way between the last two simulation ticks
+    void Extract(float _cameraX, float _viewWidth, float _alpha, vector<SpriteInstance>& _out);
+
+    // Draw extracted sprites; touches no entity state, so it may overlap the next simulation
+    static void Draw(Renderer* _renderer, const vector<SpriteInstance>& _sprites);
 };
 
 #endif
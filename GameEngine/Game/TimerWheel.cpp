@@ -0,0 +1,172 @@
+#include "TimerWheel.h"
+#include <cmath>
+
+constexpr uint32_t TimerWheel::TICKS_PER_SECOND;
+constexpr uint32_t TimerWheel::SLOT_BITS;
+constexpr uint32_t TimerWheel::SLOTS;
+constexpr uint32_t TimerWheel::LEVELS;
+constexpr uint32_t TimerWheel::NONE;
+
+TimerWheel::TimerWheel()
+{
+    m_slots.fill(NONE);
+}
+
+void TimerWheel::SetHandler(TimerKind _kind, std::function<void(EntityID)> _handler)
+{
+    m_handlers[static_cast<size_t>(_kind)] = std::move(_handler);
+}
+
+void TimerWheel::Start(TimerID& _timer, EntityID _entity, TimerKind _kind, float _seconds)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    uint32_t old = Find(_timer);
+    if (old != NONE) Release(old);
+
+    uint32_t index;
+    if (!m_freeIndices.empty())
+    {
+        index = m_freeIndices.back();
+        m_freeIndices.pop_back();
+    }
+    else
+    {
+        index = (uint32_t)m_timers.size();
+        m_timers.emplace_back();
+    }
+
+    // Round up, and never into the tick already processed
+    Timer& timer = m_timers[index];
+    uint64_t ticks = (uint64_t)std::ceil(std::max(_seconds, 0.0f) * TICKS_PER_SECOND);
+    timer.expire = m_now + std::max<uint64_t>(ticks, 1);
+    timer.entity = _entity;
+    timer.kind = _kind;
+    Insert(index);
+    ++m_pending;
+
+    _timer = (timer.version << INDEX_BITS) | index;
+}
+
+void TimerWheel::Cancel(TimerID& _timer)
+{
+    if (_timer == INVALID_TIMER) return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint32_t index = Find(_timer);
+    if (index != NONE) Release(index);
+    _timer = INVALID_TIMER;
+}
+
+void TimerWheel::Advance(float _deltaTime)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_time += _deltaTime;
+        uint64_t target = (uint64_t)(m_time * TICKS_PER_SECOND);
+
+        while (m_now < target)
+        {
+            ++m_now;
+
+            // Each level whose lower levels all wrapped hands its current slot down, coarsest first
+            uint32_t wrapped = 0;
+            while (wrapped + 1 < LEVELS && (m_now & ((1ull << (SLOT_BITS * (wrapped + 1))) - 1)) == 0)
+                ++wrapped;
+            for (uint32_t level = wrapped; level > 0; --level)
+                Cascade(level);
+
+            // Everything left in this level 0 slot is due now
+            uint32_t slot = (uint32_t)(m_now & (SLOTS - 1));
+            while (m_slots[slot] != NONE)
+            {
+                uint32_t index = m_slots[slot];
+                m_fired.push_back({ m_timers[index].entity, m_timers[index].kind });
+                Release(index);
+            }
+        }
+    }
+
+    // Unlocked, so handlers can start follow-up timers
+    for (const Fired& fired : m_fired)
+    {
+        auto& handler = m_handlers[static_cast<size_t>(fired.kind)];
+        if (handler) handler(fired.entity);
+    }
+    m_fired.clear();
+}
+
+void TimerWheel::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (uint32_t index = 0; index < m_timers.size(); ++index)
+        if (m_timers[index].slot != NONE) Release(index);
+}
+
+uint32_t TimerWheel::Find(TimerID _timer) const
+{
+    if (_timer == INVALID_TIMER) return NONE;
+    uint32_t index = _timer & INDEX_MASK;
+    if (index >= m_timers.size()) return NONE;
+
+    const Timer& timer = m_timers[index];
+    return (timer.slot != NONE && timer.version == (_timer >> INDEX_BITS)) ? index : NONE;
+}
+
+void TimerWheel::Insert(uint32_t _index)
+{
+    Timer& timer = m_timers[_index];
+
+    // Beyond the top level's reach: clamp to the latest tick it can hold
+    uint64_t maxDelta = (1ull << (SLOT_BITS * LEVELS)) - 1;
+    if (timer.expire - m_now > maxDelta) timer.expire = m_now + maxDelta;
+
+    uint64_t delta = timer.expire - m_now;
+    uint32_t level = 0;
+    while (level + 1 < LEVELS && delta >= (1ull << (SLOT_BITS * (level + 1))))
+        ++level;
+
+    uint32_t slot = level * SLOTS + (uint32_t)((timer.expire >> (SLOT_BITS * level)) & (SLOTS - 1));
+    timer.slot = slot;
+    timer.prev = NONE;
+    timer.next = m_slots[slot];
+    if (timer.next != NONE) m_timers[timer.next].prev = _index;
+    m_slots[slot] = _index;
+}
+
+void TimerWheel::Unlink(uint32_t _index)
+{
+    Timer& timer = m_timers[_index];
+    if (timer.prev != NONE) m_timers[timer.prev].next = timer.next;
+    else m_slots[timer.slot] = timer.next;
+    if (timer.next != NONE) m_timers[timer.next].prev = timer.prev;
+    timer.slot = NONE;
+}
+
+void TimerWheel::Release(uint32_t _index)
+{
+    Unlink(_index);
+
+    // Stale handles stop matching; version 0 is skipped so no handle is INVALID_TIMER
+    Timer& timer = m_timers[_index];
+    timer.version = (timer.version + 1) & VERSION_MASK;
+    if (timer.version == 0) timer.version = 1;
+
+    m_freeIndices.push_back(_index);
+    --m_pending;
+}
+
+void TimerWheel::Cascade(uint32_t _level)
+{
+    uint32_t slot = _level * SLOTS + (uint32_t)((m_now >> (SLOT_BITS * _level)) & (SLOTS - 1));
+    uint32_t index = m_slots[slot];
+    m_slots[slot] = NONE;
+
+    // Every timer here is due within this slot's span, so each lands in a finer level
+    while (index != NONE)
+    {
+        uint32_t next = m_timers[index].next;
+        Insert(index);
+        index = next;
+    }
+}
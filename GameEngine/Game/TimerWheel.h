@@ -0,0 +1,111 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include "Entity.h"
+#include <array>
+#include <functional>
+#include <mutex>
+
+// Generational timer handle, packed like EntityID. Firing or cancelling a timer
+// bumps its slot's version, so a handle kept after that matches nothing.
+using TimerID = uint32_t;
+constexpr TimerID INVALID_TIMER = 0;
+
+// What expired; each kind has one handler
+enum class TimerKind : uint8_t
+{
+    InvincibilityEnd,
+    DeathEnd,           // Death animation finished
+    DashEnd,
+    DashCooldownEnd,
+    PunchEnd,
+    JumpHoldEnd,
+    CoyoteEnd,
+    Count
+};
+
+/**
+ * Gameplay timers on a hierarchical timing wheel.
+ *
+ * Components keep a TimerID for each running timer instead of a float they
+ * count down every tick; the wheel calls the kind's handler with the entity
+ * once it expires. Time is cut into ticks of 1/TICKS_PER_SECOND. Timers due
+ * within SLOTS ticks sit in the level 0 slot of their tick, later ones in a
+ * coarser level whose slots each span SLOTS times more; when level 0 wraps,
+ * the next level's current slot is spread back down. Advancing a tick costs
+ * one slot visit plus the timers in it, so an update is proportional to the
+ * timers expiring, not to the entities that have timer fields.
+ *
+ * Start() and Cancel() are thread-safe, so systems can call them from jobs.
+ * Advance() runs on the thread that owns the simulation, between system
+ * updates; handlers are called from it and may start new timers.
+ */
+class TimerWheel
+{
+public:
+    static constexpr uint32_t TICKS_PER_SECOND = 120;
+    static constexpr uint32_t SLOT_BITS = 6;
+    static constexpr uint32_t SLOTS = 1u << SLOT_BITS;     // Per level
+    static constexpr uint32_t LEVELS = 4;                   // Longest timer ~38 hours
+
+    TimerWheel();
+
+    // Called from Advance() with the entity the timer belongs to (may be destroyed by then)
+    void SetHandler(TimerKind _kind, std::function<void(EntityID)> _handler);
+
+    // (Re)start the timer in _timer: cancels what it held, fires after _seconds
+    void Start(TimerID& _timer, EntityID _entity, TimerKind _kind, float _seconds);
+
+    // Stop the timer in _timer without firing it and reset _timer to INVALID_TIMER
+    void Cancel(TimerID& _timer);
+
+    // Move time forward and fire every timer that came due, tick by tick
+    void Advance(float _deltaTime);
+
+    // Drop all timers without firing them
+    void Clear();
+
+    uint32_t GetPendingCount() const { return m_pending; }
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+    static constexpr uint32_t INDEX_BITS = 20;
+    static constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+    static constexpr uint32_t VERSION_MASK = (1u << (32 - INDEX_BITS)) - 1;
+    static constexpr size_t KIND_COUNT = static_cast<size_t>(TimerKind::Count);
+
+    struct Timer
+    {
+        uint64_t expire = 0;        // Wheel tick
+        EntityID entity = INVALID_ENTITY;
+        TimerKind kind = TimerKind::Count;
+        uint32_t version = 1;
+        uint32_t slot = NONE;       // level * SLOTS + slot while scheduled
+        uint32_t prev = NONE, next = NONE;
+    };
+
+    struct Fired
+    {
+        EntityID entity;
+        TimerKind kind;
+    };
+
+    uint32_t Find(TimerID _timer) const;   // Index of a scheduled timer, or NONE
+    void Insert(uint32_t _index);
+    void Unlink(uint32_t _index);
+    void Release(uint32_t _index);
+    void Cascade(uint32_t _level);
+
+    std::vector<Timer> m_timers;
+    std::vector<uint32_t> m_freeIndices;
+    std::array<uint32_t, LEVELS * SLOTS> m_slots;   // First timer in each slot
+    std::vector<Fired> m_fired;                     // Collected under the lock, handled after
+    uint64_t m_now = 0;                             // Last tick processed
+    double m_time = 0;                              // Seconds advanced
+    uint32_t m_pending = 0;
+    std::mutex m_mutex;
+
+    std::array<std::function<void(EntityID)>, KIND_COUNT> m_handlers;
+};
+
+#endif // TIMER_WHEEL_H
@@ -0,0 +1,72 @@
+#include "../Graphics/AnimationSet.h"
+
+Rect AnimationClip::GetFrameRect(float _clipTime) const
+{
+    if (frameCount <= 0) return Rect(0, 0, 0, 0);
+
+    short frame = (short)_clipTime;
+    if (frame >= frameCount) frame = frameCount - 1;
+
+    // Calculate position in sprite sheet
+    short posX = (frame % columns) * clipSizeX;
+    short posY = (frame / columns) * clipSizeY;
+    return Rect(posX, posY, posX + clipSizeX, posY + clipSizeY);
+}
+
+void AnimationSet::AddClip(AnimClip _clip, const string& _filePath,
+    byte _columns, byte _clipSizeX, byte _clipSizeY,
+    short _frameCount, float _frameRate)
+{
+    AnimationClip& clip = m_clips[(int)_clip];
+
+    clip.texture = Texture::Pool->GetResource();
+    clip.texture->Load(_filePath);
+    clip.columns = _columns;
+    clip.clipSizeX = _clipSizeX;
+    clip.clipSizeY = _clipSizeY;
+    clip.frameCount = _frameCount;
+    clip.frameRate = _frameRate;
+}
+
+const AnimationClip& AnimationSet::GetClip(AnimClip _clip) const
+{
+    const AnimationClip& clip = m_clips[(int)_clip];
+    return clip.texture ? clip : m_clips[(int)AnimClip::Idle];
+}
+
+void AnimationSet::Release()
+{
+    for (auto& clip : m_clips)
+    {
+        if (clip.texture)
+        {
+            Texture::Pool->ReleaseResource(clip.texture);
+        }
+        clip = AnimationClip();
+    }
+}
+
+void AnimationLibrary::Load()
+{
+    AnimationSet& player = m_sets[(int)AnimSetID::Player];
+    player.AddClip(AnimClip::Idle, "../Assets/Textures/Player/idle.png", 4, 16, 16, 4, 8.0f);
+    player.AddClip(AnimClip::Run, "../Assets/Textures/Player/run.png", 4, 16, 16, 4, 12.0f);
+    player.AddClip(AnimClip::JumpAndFall, "../Assets/Textures/Player/jumpandfall.png", 2, 16, 16, 2, 8.0f);
+    player.AddClip(AnimClip::Hurt, "../Assets/Textures/Player/hurt.png", 2, 16, 16, 2, 2.0f);
+    player.AddClip(AnimClip::Punch, "../Assets/Textures/Player/punch1.png", 4, 16, 16, 4, 12.0f);
+
+    m_sets[(int)AnimSetID::Ghost].AddClip(AnimClip::Idle, "../Assets/Textures/Enemy/ghost1_fly.png", 6, 16, 16, 6, 10.0f);
+    m_sets[(int)AnimSetID::Mushroom].AddClip(AnimClip::Idle, "../Assets/Textures/Enemy/mushroom-walk.png", 10, 16, 16, 10, 10.0f);
+
+    m_sets[(int)AnimSetID::Coin1].AddClip(AnimClip::Idle, "../Assets/Textures/Obstacles/coin1.png", 10, 16, 16, 10, 10.0f);
+    m_sets[(int)AnimSetID::Coin2].AddClip(AnimClip::Idle, "../Assets/Textures/Obstacles/coin2.png", 10, 16, 16, 10, 10.0f);
+    m_sets[(int)AnimSetID::Diamond].AddClip(AnimClip::Idle, "../Assets/Textures/Obstacles/diamond.png", 5, 16, 16, 5, 10.0f);
+}
+
+void AnimationLibrary::Unload()
+{
+    for (auto& set : m_sets)
+    {
+        set.Release();
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef ANIMATIONSET_H
+#define ANIMATIONSET_H
+
+#include "../Graphics/Texture.h"
+#include "../Core/BasicStructs.h"
+
+using namespace std;
+
+// Clips an animation set can hold. Replaces the per-entity animation name strings.
+enum class AnimClip : uint8_t
+{
+    Idle,
+    Run,
+    JumpAndFall,
+    Hurt,
+    Punch,
+    Count
+};
+
+// Shared animation sets, one per kind of entity
+enum class AnimSetID : uint8_t
+{
+    Player,
+    Ghost,
+    Mushroom,
+    Coin1,
+    Coin2,
+    Diamond,
+    Count
+};
+
+// One sprite sheet strip: immutable once loaded
+struct AnimationClip
+{
+    Texture* texture = nullptr;
+    byte columns = 1;
+    byte clipSizeX = 0;
+    byte clipSizeY = 0;
+    short frameCount = 0;
+    float frameRate = 0;     // Frames per second
+
+    // Source rect of the frame shown _clipTime frames into the clip
+    Rect GetFrameRect(float _clipTime) const;
+};
+
+/**
+ * Immutable set of clips shared by every entity of one kind (flyweight).
+ * Entities only store a playback cursor (clip, time, flip) in SpriteComponent.
+ */
+class AnimationSet
+{
+public:
+    //Methods
+    void AddClip(AnimClip _clip, const string& _filePath,
+                 byte _columns, byte _clipSizeX, byte _clipSizeY,
+                 short _frameCount, float _frameRate);
+
+    // Falls back to Idle for clips this set does not have
+    const AnimationClip& GetClip(AnimClip _clip) const;
+
+    void Release();
+
+private:
+    AnimationClip m_clips[(int)AnimClip::Count];
+};
+
+/**
+ * Owns all animation sets. Load() reads every sheet once at startup;
+ * factories hand out const pointers to the shared sets.
+ */
+class AnimationLibrary : public Singleton<AnimationLibrary>
+{
+public:
+    //Methods
+    void Load();
+    void Unload();
+
+    const AnimationSet* Get(AnimSetID _id) const { return &m_sets[(int)_id]; }
+
+private:
+    AnimationSet m_sets[(int)AnimSetID::Count];
+};
+
+#endif // ANIMATIONSET_H
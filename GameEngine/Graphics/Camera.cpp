@@ -18,20 +18,17 @@ void Camera::Update(float _deltaTime)
 {
 }
 
-void Camera::FollowEntity(Entity* _entity, Renderer* _renderer)
+void Camera::FollowEntity(Entity* _entity, int _viewWidth, float _alpha)
 {
-	if (!_entity || !_renderer) return;
+	if (!_entity) return;
 
 	auto* transform = _entity->GetComponent<TransformComponent>();
 	if (!transform) return;
 
-	float entityWorldX = transform->worldX;
+	float entityWorldX = InterpolatedX(*transform, _alpha);
 	float entityWidth = transform->width * transform->scale;
-	
-	Point logicalSize = _renderer->GetLogicalSize();
-	int logicalWidth = logicalSize.X;
 
-	float targetX = entityWorldX + entityWidth * 0.5f - logicalWidth * 0.5f;
+	float targetX = entityWorldX + entityWidth * 0.5f - _viewWidth * 0.5f;
 	if (targetX < 0) targetX = 0;
 
 	if (targetX > m_maxX)
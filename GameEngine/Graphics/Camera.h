@@ -13,7 +13,9 @@ public:
 	virtual ~Camera();
 
 	void Update(float _deltaTime);
-	void FollowEntity(Entity* _entity, Renderer* _renderer);
+	// _alpha picks the entity's position between its last two simulation ticks.
+	// Takes the view width rather than the Renderer so it can run off the main thread
+	void FollowEntity(Entity* _entity, int _viewWidth, float _alpha = 1.0f);
 
 	float GetX() const { return m_x; }
 	float GetY() const { return m_y; }
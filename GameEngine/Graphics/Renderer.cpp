@@ -9,6 +9,9 @@ Renderer::Renderer()
     m_destRect = { };
     m_surface = nullptr;
     m_viewPort = { };
+    m_frameTarget = nullptr;
+    m_resolutionScale = 1.0f;
+    m_frameTargetBound = false;
 }
 
 Renderer::~Renderer()
@@ -72,6 +75,11 @@ void Renderer::Shutdown()
         SDL_DestroyTexture(it->second);
     }
     m_textures.clear();
+    if (m_frameTarget != nullptr)
+    {
+        SDL_DestroyTexture(m_frameTarget);
+        m_frameTarget = nullptr;
+    }
     if (m_renderer != nullptr)
     {
         SDL_DestroyRenderer(m_renderer);
@@ -95,6 +103,47 @@ void Renderer::ClearScreen()
     SDL_RenderClear(m_renderer);
 }
 
+void Renderer::SetResolutionScale(float _scale)
+{
+    m_resolutionScale = _scale < 1.0f ? _scale : 1.0f;
+}
+
+void Renderer::BeginFrame()
+{
+    if (m_resolutionScale >= 1.0f) return;
+
+    // Same aspect as the logical size, _scale of the window's pixels
+    m_frameLogicalSize = GetLogicalSize();
+    int outputWidth, outputHeight;
+    SDL_GetRendererOutputSize(m_renderer, &outputWidth, &outputHeight);
+    float pixelsPerUnit = (float)outputHeight / m_frameLogicalSize.Y * m_resolutionScale;
+    Point size((unsigned int)(m_frameLogicalSize.X * pixelsPerUnit), (unsigned int)(m_frameLogicalSize.Y * pixelsPerUnit));
+
+    if (m_frameTarget == nullptr || size.X != m_frameTargetSize.X || size.Y != m_frameTargetSize.Y)
+    {
+        if (m_frameTarget != nullptr) SDL_DestroyTexture(m_frameTarget);
+        m_frameTarget = SDL_CreateTexture(m_renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, size.X, size.Y);
+        m_frameTargetSize = size;
+        if (m_frameTarget == nullptr) return;
+    }
+
+    // Binding a target resets the scale to 1; draw calls keep using logical units
+    SDL_SetRenderTarget(m_renderer, m_frameTarget);
+    SDL_RenderSetScale(m_renderer, pixelsPerUnit, pixelsPerUnit);
+    m_frameTargetBound = true;
+}
+
+void Renderer::Present()
+{
+    if (m_frameTargetBound)
+    {
+        SDL_SetRenderTarget(m_renderer, nullptr);
+        SDL_RenderCopy(m_renderer, m_frameTarget, nullptr, nullptr);
+        m_frameTargetBound = false;
+    }
+    SDL_RenderPresent(m_renderer);
+}
+
 void Renderer::RenderPoint(Point _position)
 {
     SDL_RenderDrawPoint(m_renderer, _position.X, _position.Y);
@@ -164,6 +213,9 @@ Point Renderer::GetWindowSize()
 
 Point Renderer::GetLogicalSize()
 {
+    if (m_frameTargetBound)
+        return m_frameLogicalSize;
+
     int w;
     int h;
     SDL_RenderGetLogicalSize(m_renderer, &w, &h);
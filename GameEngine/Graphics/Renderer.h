@@ -18,6 +18,11 @@ public:
     SDL_Renderer* GetRenderer() { return m_renderer; }
     SDL_Texture* GetSDLTexture(Texture* _texture);
     vector<SDL_DisplayMode>& GetResolutions() { return m_resolutions; }
+    float GetResolutionScale() { return m_resolutionScale; }
+
+    // Draw frames at _scale (0..1] of the window's resolution and stretch them to
+    // fit on Present(); 1 draws straight to the window
+    void SetResolutionScale(float _scale);
     
     // Methods
     void Initialize();
@@ -29,6 +34,10 @@ public:
     void SetLogicalSizeFromMapHeight(int _mapHeight);
     void SetDrawColor(Color _color);
     void ClearScreen();
+
+    // Bracket each frame's drawing; Present() shows it
+    void BeginFrame();
+    void Present();
     void SetViewport(Rect _viewport);
     void RenderPoint(Point _position);
     void RenderLine(Rect _points);
@@ -50,6 +59,13 @@ private:
     SDL_Rect m_viewPort;
     map<string, SDL_Texture*> m_textures;
     vector<SDL_DisplayMode> m_resolutions;
+
+    // Offscreen target used while the resolution scale is below 1
+    SDL_Texture* m_frameTarget;
+    Point m_frameTargetSize;
+    Point m_frameLogicalSize;       // Window's logical size, hidden by SDL while the target is bound
+    float m_resolutionScale;
+    bool m_frameTargetBound;
 };
 
 #endif // RENDERER_H
@@ -0,0 +1,57 @@
+#include "../Utils/PoolAllocator.h"
+
+FixedBlockPool::FixedBlockPool(size_t _blockSize, size_t _blocksPerSlab)
+{
+	// Every block must be able to hold a free-list link while unused
+	m_blockSize = _blockSize < sizeof(FreeNode) ? sizeof(FreeNode) : _blockSize;
+	m_blocksPerSlab = _blocksPerSlab > 0 ? _blocksPerSlab : 1;
+	m_blocksInUse = 0;
+	m_freeList = nullptr;
+}
+
+FixedBlockPool::~FixedBlockPool()
+{
+	for (unsigned int count = 0; count < m_slabs.size(); count++)
+	{
+		::operator delete(m_slabs[count]);
+	}
+	m_slabs.clear();
+	m_freeList = nullptr;
+}
+
+void* FixedBlockPool::Allocate()
+{
+	if (m_freeList == nullptr)
+	{
+		AllocateSlab();
+	}
+
+	FreeNode* block = m_freeList;
+	m_freeList = block->next;
+	m_blocksInUse++;
+	return block;
+}
+
+void FixedBlockPool::Free(void* _block)
+{
+	if (_block == nullptr) return;
+
+	FreeNode* node = static_cast<FreeNode*>(_block);
+	node->next = m_freeList;
+	m_freeList = node;
+	m_blocksInUse--;
+}
+
+void FixedBlockPool::AllocateSlab()
+{
+	unsigned char* slab = static_cast<unsigned char*>(::operator new(m_blockSize * m_blocksPerSlab));
+	m_slabs.push_back(slab);
+
+	// Thread the new blocks onto the free list, lowest address first
+	for (size_t index = m_blocksPerSlab; index > 0; index--)
+	{
+		FreeNode* node = reinterpret_cast<FreeNode*>(slab + (index - 1) * m_blockSize);
+		node->next = m_freeList;
+		m_freeList = node;
+	}
+}
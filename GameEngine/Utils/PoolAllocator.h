@@ -0,0 +1,83 @@
+#pragma once
+
+#ifndef POOL_ALLOCATOR_H
+#define POOL_ALLOCATOR_H
+
+#include <vector>
+#include <new>
+#include <utility>
+#include <cstddef>
+
+// Fixed-size raw blocks carved out of larger slabs. Freed blocks go on an
+// intrusive free list and are handed out again before any new slab is allocated,
+// so steady create/destroy churn does no general-purpose heap traffic.
+class FixedBlockPool
+{
+public:
+	// Constructors/ Destructors
+	FixedBlockPool(size_t _blockSize, size_t _blocksPerSlab);
+	~FixedBlockPool();
+	FixedBlockPool(const FixedBlockPool&) = delete;
+	FixedBlockPool& operator=(const FixedBlockPool&) = delete;
+
+	//Accessors
+	size_t GetBlockSize() const { return m_blockSize; }
+	size_t GetSlabCount() const { return m_slabs.size(); }
+	size_t GetBlocksInUse() const { return m_blocksInUse; }
+
+	//Methods
+	void* Allocate();
+	void Free(void* _block);
+
+private:
+	struct FreeNode { FreeNode* next; };
+
+	void AllocateSlab();
+
+	//Members
+	size_t m_blockSize;
+	size_t m_blocksPerSlab;
+	size_t m_blocksInUse;
+	FreeNode* m_freeList;
+	std::vector<unsigned char*> m_slabs;
+};
+
+// Typed object pool on top of FixedBlockPool: Create() constructs in a pooled
+// slot, Destroy() runs the destructor and returns the slot.
+template<class T>
+class PoolAllocator
+{
+public:
+	// Constructors/ Destructors
+	PoolAllocator(size_t _objectsPerSlab = 256) : m_blocks(SlotSize(), _objectsPerSlab) { }
+
+	//Methods
+	template<typename... Args>
+	T* Create(Args&&... _args)
+	{
+		void* slot = m_blocks.Allocate();
+		return new (slot) T(std::forward<Args>(_args)...);
+	}
+
+	void Destroy(T* _object)
+	{
+		if (!_object) return;
+		_object->~T();
+		m_blocks.Free(_object);
+	}
+
+	const FixedBlockPool& GetBlocks() const { return m_blocks; }
+
+private:
+	// Slots hold a T or a free-list link, aligned for T
+	static size_t SlotSize()
+	{
+		size_t size = sizeof(T) < sizeof(void*) ? sizeof(void*) : sizeof(T);
+		return (size + alignof(T) - 1) / alignof(T) * alignof(T);
+	}
+
+	//Members
+	FixedBlockPool m_blocks;
+};
+
+#endif //POOL_ALLOCATOR_H